@@ -1,17 +1,121 @@
 #include "BMSLib.h"
 
-BMSLib::BMSLib(TwoWire &wirePort) : 
+namespace {
+
+// Register descriptor of each BMSLib::Field, indexed by the enum value. The type byte
+// packs the width with the decode rule, so the whole table stays two bytes per register
+// and every typed accessor, burst decoder and snapshot shares one decode path.
+enum FieldType : uint8_t {
+    FIELD_RAW         = 0,    // Value as read
+    FIELD_PERCENT     = 1,    // Clamped to 100
+    FIELD_VOLTAGE     = 2,    // validateVoltage()
+    FIELD_CURRENT     = 3,    // Signed, validateCurrent()
+    FIELD_TEMPERATURE = 4,    // validateTemperature()
+    FIELD_CHECK_MASK  = 0x0F,
+    FIELD_BYTE        = 0x80  // Single-byte register
+};
+
+struct FieldInfo {
+    uint8_t reg;
+    uint8_t type;
+};
+
+const FieldInfo FIELD_INFO[] = {
+    { BMS_REG_CNTL,    FIELD_RAW },
+    { BMS_REG_SOC,     FIELD_BYTE | FIELD_PERCENT },
+    { BMS_REG_ME,      FIELD_BYTE | FIELD_PERCENT },
+    { BMS_REG_RM,      FIELD_RAW },
+    { BMS_REG_FCC,     FIELD_RAW },
+    { BMS_REG_VOLT,    FIELD_VOLTAGE },
+    { BMS_REG_AI,      FIELD_RAW },
+    { BMS_REG_TEMP,    FIELD_TEMPERATURE },
+    { BMS_REG_FLAGS,   FIELD_RAW },
+    { BMS_REG_CURRENT, FIELD_CURRENT },
+    { BMS_REG_FLAGSB,  FIELD_RAW },
+    { BMS_REG_ATTE,    FIELD_RAW },
+    { BMS_REG_ATTF,    FIELD_RAW },
+    { BMS_REG_PCHG,    FIELD_RAW },
+    { BMS_REG_DOD0T,   FIELD_RAW },
+    { BMS_REG_AE,      FIELD_RAW },
+    { BMS_REG_AP,      FIELD_RAW },
+    { BMS_REG_SERNUM,  FIELD_RAW },
+    { BMS_REG_INTTEMP, FIELD_RAW },
+    { BMS_REG_CC,      FIELD_RAW },
+    { BMS_REG_SOH,     FIELD_BYTE | FIELD_PERCENT },
+    { BMS_REG_CHGV,    FIELD_RAW },
+    { BMS_REG_CHGI,    FIELD_RAW },
+    { BMS_REG_PKCFG,   FIELD_RAW },
+    { BMS_REG_DCAP,    FIELD_RAW },
+};
+
+static_assert(sizeof(FIELD_INFO) / sizeof(FIELD_INFO[0]) ==
+              static_cast<uint8_t>(BMSLib::Field::COUNT),
+              "FIELD_INFO must cover every BMSLib::Field");
+
+inline uint8_t fieldWidth(uint8_t index) {
+    return (FIELD_INFO[index].type & FIELD_BYTE) ? 1 : 2;
+}
+
+} // namespace
+
+BMSLib::BMSLib(BMSBus &wirePort, uint8_t address) : 
     _wire(&wirePort),
-    _configMode(false) {
+    _address(address),
+    _lastStatus(Status::OK),
+    _splitStatus(Status::OK),
+    _splitPending(false),
+    _configMode(false),
+    _dfClass(0),
+    _dfBlock(0),
+    _configDepth(0),
+    _configScoped(false),
+    _session(nullptr),
+    _opCount(0),
+    _opIndex(0),
+    _opHandle(0),
+    _opState(OpState::IDLE),
+    _opFailed(false),
+    _opWaiting(false),
+    _opStepLive(false),
+    _opScopeHeld(false),
+    _opWaitStart(0),
+    _opWaitMs(0),
+    _cacheEnabled(false),
+    _shadowClock(0) {
+    _transport.timeoutUs = BMS_TRANSPORT_TIMEOUT_US;
+    _transport.retries = BMS_TRANSPORT_RETRIES;
+    _transport.backoffUs = BMS_TRANSPORT_BACKOFF_US;
+    _transport.sdaPin = -1;
+    _transport.sclPin = -1;
+    _transport.clockHz = 0;
+#ifdef BMS_BUS_ASYNC
+    _splitRunning = false;
+#endif
+    resetBusStats();
+    resetCacheStats();
+#if BMS_READ_CACHE_ENTRIES > 0
+    memset(_cache, 0, sizeof(_cache));
+#endif
+    invalidateShadow();
+#if BMS_SNAPSHOT_LISTENERS > 0
+    memset(_listeners, 0, sizeof(_listeners));
+#endif
 }
 
 BMSLib::~BMSLib() {
 }
 
 bool BMSLib::begin() {
-    _wire->begin();
-    delay(100);  // Allow I2C to stabilize
-    return isOnline();
+    waitOp(_opHandle);
+    return waitOp(beginAsync());
+}
+
+BMSBus& BMSLib::getWire() const {
+    return *_wire;
+}
+
+uint8_t BMSLib::getAddress() const {
+    return _address;
 }
 
 void BMSLib::getVersion(uint8_t &major, uint8_t &minor, uint8_t &patch) {
@@ -26,107 +130,97 @@ bool BMSLib::isOnline() {
 }
 
 bool BMSLib::readWord(uint8_t command, uint16_t &value) {
-    _wire->beginTransmission(BMS_I2C_ADDRESS);
-    _wire->write(command);
-    if (_wire->endTransmission(false) != 0) {
-        return false;
+    if (cacheLookup(command, value)) {
+        return true;
     }
-    
-    if (_wire->requestFrom(BMS_I2C_ADDRESS, (uint8_t)2) != 2) {
+
+    uint8_t buffer[2];
+    if (!readBlock(command, buffer, sizeof(buffer))) {
         return false;
     }
-    
-    uint8_t lowByte = _wire->read();
-    uint8_t highByte = _wire->read();
-    value = (highByte << 8) | lowByte;
-    
+    value = (buffer[1] << 8) | buffer[0];
+
+    cacheStore(command, value);
     return true;
 }
 
-bool BMSLib::writeWord(uint8_t command, uint16_t data) {
-    _wire->beginTransmission(BMS_I2C_ADDRESS);
-    _wire->write(command);
-    _wire->write(data & 0xFF);        // Low byte
-    _wire->write((data >> 8) & 0xFF); // High byte
-    return (_wire->endTransmission() == 0);
+bool BMSLib::readBlock(uint8_t command, uint8_t* data, uint8_t length) {
+    return transferRead(command, data, length) == Status::OK;
 }
 
-uint16_t BMSLib::readVoltage() {
-    uint16_t value;
-    if (!readWord(BMS_REG_VOLT, value) || !validateVoltage(value)) {
-        return 0;
+bool BMSLib::writeWord(uint8_t command, uint16_t data) {
+    // Journal the previous value so a failed session can be rolled back
+    if (_session != nullptr && _session->_rollback && command != BMS_REG_CNTL) {
+        _session->record(command);
     }
-    return value;
-}
 
-int16_t BMSLib::readCurrent() {
-    uint16_t value;
-    if (!readWord(BMS_REG_CURRENT, value)) {
-        return 0;
-    }
-    int16_t current = static_cast<int16_t>(value);
-    if (!validateCurrent(current)) {
-        return 0;
-    }
-    return current;
+    uint8_t buffer[2];
+    buffer[0] = data & 0xFF;          // Low byte
+    buffer[1] = (data >> 8) & 0xFF;   // High byte
+    return writeBlock(command, buffer, sizeof(buffer));
 }
 
-uint16_t BMSLib::readTemperature() {
-    uint16_t value;
-    if (!readWord(BMS_REG_TEMP, value) || !validateTemperature(value)) {
-        return 0;
-    }
-    return value;
+bool BMSLib::writeBlock(uint8_t command, const uint8_t* data, uint8_t length) {
+    // Drop cached values before the write, so a failed write cannot leave them stale
+    cacheInvalidate(command, length);
+    return transferWrite(command, data, length) == Status::OK;
 }
 
-uint16_t BMSLib::readSoC() {
-    uint16_t value;
-    if (!readWord(BMS_REG_SOC, value)) {
-        return 0;
+bool BMSLib::readField(Field field, uint16_t& value) {
+    uint16_t raw;
+    value = 0;
+    if (!readWord(FIELD_INFO[static_cast<uint8_t>(field)].reg, raw)) {
+        return false;
     }
-    return value > 100 ? 100 : value;
-}
 
-uint16_t BMSLib::readSoH() {
-    uint16_t value;
-    if (!readWord(BMS_REG_SOH, value)) {
-        return 0;
+    uint8_t data[2] = { static_cast<uint8_t>(raw), static_cast<uint8_t>(raw >> 8) };
+    if (!decodeField(field, data, value)) {
+        _lastStatus = Status::OUT_OF_RANGE;
+        return false;
     }
-    return value > 100 ? 100 : value;
+    return true;
 }
 
-uint16_t BMSLib::readCycleCount() {
-    uint16_t value;
-    if (!readWord(BMS_REG_CC, value)) {
-        return 0;
-    }
-    return value;
+uint8_t BMSLib::fieldRegister(Field field) {
+    return FIELD_INFO[static_cast<uint8_t>(field)].reg;
 }
 
-uint16_t BMSLib::readDesignCapacity() {
+uint16_t BMSLib::readFieldOrZero(Field field) {
     uint16_t value;
-    if (!readWord(BMS_REG_DCAP, value)) {
-        return 0;
-    }
+    readField(field, value);
     return value;
 }
 
-uint16_t BMSLib::readFullChargeCapacity() {
-    uint16_t value;
-    if (!readWord(BMS_REG_FCC, value)) {
-        return 0;
+bool BMSLib::decodeField(Field field, const uint8_t* data, uint16_t& value) {
+    uint8_t type = FIELD_INFO[static_cast<uint8_t>(field)].type;
+    uint16_t raw = data[0];
+    if ((type & FIELD_BYTE) == 0) {
+        raw |= data[1] << 8;
     }
-    return value;
-}
 
-uint16_t BMSLib::readRemainingCapacity() {
-    uint16_t value;
-    if (!readWord(BMS_REG_RM, value)) {
-        return 0;
+    bool valid = true;
+    switch (type & FIELD_CHECK_MASK) {
+        case FIELD_PERCENT:
+            if (raw > 100) raw = 100;
+            break;
+        case FIELD_VOLTAGE:
+            valid = validateVoltage(raw);
+            break;
+        case FIELD_CURRENT:
+            valid = validateCurrent(static_cast<int16_t>(raw));
+            break;
+        case FIELD_TEMPERATURE:
+            valid = validateTemperature(raw);
+            break;
+        default:
+            break;
     }
-    return value;
+
+    value = valid ? raw : 0;
+    return valid;
 }
 
+#ifndef BMSLIB_NO_FLOAT
 float BMSLib::readVoltage_inVolts() {
     uint16_t voltage = readVoltage();
     if (voltage == 0) return 0.0f;
@@ -158,32 +252,59 @@ float BMSLib::readRemainingCapacity_inAmpHours() {
     return readRemainingCapacity() / 1000.0f;
 }
 
+float BMSLib::getAvailableEnergy_inWh() {
+    return getAvailableEnergy() / 100.0f;
+}
+
+float BMSLib::getAvailablePower_inW() {
+    return getAvailablePower() / 100.0f;
+}
+
+float BMSLib::getChargeVoltage_inVolts() {
+    return getChargeVoltage() / 1000.0f;
+}
+
+float BMSLib::getChargeCurrent_inAmps() {
+    return getChargeCurrent() / 1000.0f;
+}
+#endif
+
+uint16_t BMSLib::readVoltage_inMillivolts() {
+    uint16_t voltage = readVoltage();
+    if (voltage == 0) return 0;
+
+    return compensateTemperature_mV(voltage, readTemperature());
+}
+
+int32_t BMSLib::readTemperature_inMilliCelsius() {
+    // 0.1K to m°C: x100, then subtract 273.15°C
+    return static_cast<int32_t>(readTemperature()) * 100 - 273150L;
+}
+
 bool BMSLib::setDesignCapacity(uint16_t capacity_mAh) {
-    if (!enterConfigMode()) {
+    if (!beginConfig()) {
         return false;
     }
 
     // Write to Design Capacity register
     bool success = writeWord(BMS_REG_DCAP, capacity_mAh);
 
-    exitConfigMode();
-    return success;
+    return endConfig(success);
 }
 
 bool BMSLib::setFullChargeCapacity(uint16_t capacity_mAh) {
-    if (!enterConfigMode()) {
+    if (!beginConfig()) {
         return false;
     }
 
     // Write to Full Charge Capacity register
     bool success = writeWord(BMS_REG_FCC, capacity_mAh);
 
-    exitConfigMode();
-    return success;
+    return endConfig(success);
 }
 
 bool BMSLib::setCapacityConfig(const CapacityConfig& config) {
-    if (!enterConfigMode()) {
+    if (!beginConfig()) {
         return false;
     }
 
@@ -192,13 +313,7 @@ bool BMSLib::setCapacityConfig(const CapacityConfig& config) {
     // Write each configuration value
     success &= writeWord(BMS_REG_DCAP, config.designCapacity);
     
-    // Design Energy Data Flash Class = 48, offset = 13
-    if (!writeWord(BMS_REG_DFCLS, 48) || !writeWord(BMS_REG_DFBLK, 0)) {
-        exitConfigMode();
-        return false;
-    }
-    
-    uint8_t buffer[8];
+    uint8_t buffer[6];
     buffer[0] = config.designEnergy & 0xFF;
     buffer[1] = (config.designEnergy >> 8) & 0xFF;
     buffer[2] = config.cycleCountThresh & 0xFF;
@@ -206,118 +321,99 @@ bool BMSLib::setCapacityConfig(const CapacityConfig& config) {
     buffer[4] = config.chargeTermination;
     buffer[5] = config.reserveCapacity;
     
-    success &= writeDataFlash(13, buffer, sizeof(buffer));
+    // Design Energy Data Flash Class = 48, offset = 13
+    success &= writeShadow(48, 13, buffer, sizeof(buffer)) && flushShadow();
 
-    exitConfigMode();
-    return success;
+    return endConfig(success);
 }
 
 bool BMSLib::getCapacityConfig(CapacityConfig& config) {
-    if (!enterConfigMode()) {
-        return false;
-    }
-
-    bool success = true;
-    
     // Read Design Capacity
     uint16_t value;
-    success &= readWord(BMS_REG_DCAP, value);
-    config.designCapacity = value;
-    
-    // Read other parameters from Data Flash
-    if (!writeWord(BMS_REG_DFCLS, 48) || !writeWord(BMS_REG_DFBLK, 0)) {
-        exitConfigMode();
+    if (!readWord(BMS_REG_DCAP, value)) {
         return false;
     }
+    config.designCapacity = value;
     
-    uint8_t buffer[8];
-    success &= readDataFlash(13, buffer, sizeof(buffer));
-    
-    if (success) {
-        config.designEnergy = (buffer[1] << 8) | buffer[0];
-        config.cycleCountThresh = (buffer[3] << 8) | buffer[2];
-        config.chargeTermination = buffer[4];
-        config.reserveCapacity = buffer[5];
+    // Read other parameters from Data Flash (class 48, offset 13)
+    uint8_t buffer[6];
+    if (!readShadow(48, 13, buffer, sizeof(buffer))) {
+        return false;
     }
 
-    exitConfigMode();
-    return success;
+    config.designEnergy = (buffer[1] << 8) | buffer[0];
+    config.cycleCountThresh = (buffer[3] << 8) | buffer[2];
+    config.chargeTermination = buffer[4];
+    config.reserveCapacity = buffer[5];
+    return true;
 }
 
 bool BMSLib::calibrateVoltage(const VoltageCalibration& cal) {
-    if (!enterConfigMode()) {
+    if (!beginConfig()) {
         return false;
     }
 
     // Validate input values
     if (!validateVoltage(cal.actualVoltage) || !validateVoltage(cal.measuredVoltage)) {
-        exitConfigMode();
-        return false;
+        return endConfig(false);
     }
 
     // Calculate calibration coefficient
-    float coefficient = static_cast<float>(cal.actualVoltage) / cal.measuredVoltage;
-    uint16_t gainValue = static_cast<uint16_t>(coefficient * 1000); // Store with 3 decimal precision
+    uint16_t gainValue = calibrationGain(cal.actualVoltage, cal.measuredVoltage); // Store with 3 decimal precision
 
     // Write calibration data
     bool success = writeWord(BMS_REG_VOLTAGE_CAL, gainValue);
     
-    exitConfigMode();
-    return success;
+    return endConfig(success);
 }
 
 bool BMSLib::calibrateCurrent(const CurrentCalibration& cal) {
-    if (!enterConfigMode()) {
+    if (!beginConfig()) {
         return false;
     }
 
     // Validate input values
     if (!validateCurrent(cal.actualCurrent) || 
         !validateCurrent(cal.measuredCurrent) || 
+        cal.measuredCurrent == 0 ||
         cal.shuntResistance == 0) {
-        exitConfigMode();
-        return false;
+        return endConfig(false);
     }
 
     // Calculate calibration coefficient
-    float coefficient = static_cast<float>(cal.actualCurrent) / cal.measuredCurrent;
-    uint16_t gainValue = static_cast<uint16_t>(coefficient * 1000);
+    uint16_t gainValue = calibrationGain(cal.actualCurrent, cal.measuredCurrent);
 
     // Write calibration data
     bool success = true;
     success &= writeWord(BMS_REG_CURRENT_CAL, gainValue);
     success &= writeWord(BMS_REG_SHUNT_RESISTANCE, cal.shuntResistance);
 
-    exitConfigMode();
-    return success;
+    return endConfig(success);
 }
 
 bool BMSLib::calibrateTemperature(const TempCalibration& cal) {
-    if (!enterConfigMode()) {
+    if (!beginConfig()) {
         return false;
     }
 
     // Validate input values
     if (!validateTemperature(cal.actualTemp) || !validateTemperature(cal.measuredTemp)) {
-        exitConfigMode();
-        return false;
+        return endConfig(false);
     }
 
     // Calculate calibration coefficient
-    float coefficient = static_cast<float>(cal.actualTemp) / cal.measuredTemp;
-    uint16_t gainValue = static_cast<uint16_t>(coefficient * 1000);
+    uint16_t gainValue = calibrationGain(cal.actualTemp, cal.measuredTemp);
 
     // Write calibration data
     bool success = writeWord(BMS_REG_TEMP_CAL, gainValue);
 
-    exitConfigMode();
-    return success;
+    return endConfig(success);
 }
 
 bool BMSLib::performFullCalibration(const VoltageCalibration& vcal,
                                   const CurrentCalibration& ccal,
                                   const TempCalibration& tcal) {
-    if (!enterConfigMode()) {
+    if (!beginConfig()) {
         return false;
     }
 
@@ -334,8 +430,7 @@ bool BMSLib::performFullCalibration(const VoltageCalibration& vcal,
         success &= writeWord(BMS_REG_CAL_STATUS, calStatus);
     }
 
-    exitConfigMode();
-    return success;
+    return endConfig(success);
 }
 
 bool BMSLib::isCalibrated() {
@@ -347,7 +442,7 @@ bool BMSLib::isCalibrated() {
 }
 
 bool BMSLib::clearCalibration() {
-    if (!enterConfigMode()) {
+    if (!beginConfig()) {
         return false;
     }
 
@@ -358,28 +453,12 @@ bool BMSLib::clearCalibration() {
     success &= writeWord(BMS_REG_TEMP_CAL, 1000);     // 1.000 gain
     success &= writeWord(BMS_REG_CAL_STATUS, 0x0000); // Clear calibration status
 
-    exitConfigMode();
-    return success;
+    return endConfig(success);
 }
 
 bool BMSLib::setBatteryChemistry(BatteryChemistry chemistry) {
-    if (!isChemistrySupported(chemistry)) {
-        return false;
-    }
-
-    if (!enterConfigMode()) {
-        return false;
-    }
-
-    bool success = writeWord(BMS_REG_CHEM, static_cast<uint16_t>(chemistry));
-    
-    // Allow time for chemistry change to take effect
-    if (success) {
-        delay(100);
-    }
-
-    exitConfigMode();
-    return success;
+    waitOp(_opHandle);
+    return waitOp(setBatteryChemistryAsync(chemistry));
 }
 
 BMSLib::BatteryChemistry BMSLib::getBatteryChemistry() {
@@ -397,7 +476,7 @@ bool BMSLib::isChemistrySupported(BatteryChemistry chemistry) {
 }
 
 bool BMSLib::configureSelfDischarge(const SelfDischargeConfig& config) {
-    if (!enterConfigMode()) {
+    if (!beginConfig()) {
         return false;
     }
 
@@ -409,8 +488,7 @@ bool BMSLib::configureSelfDischarge(const SelfDischargeConfig& config) {
 
     bool success = writeWord(BMS_REG_SELF_DISCH, configValue);
 
-    exitConfigMode();
-    return success;
+    return endConfig(success);
 }
 
 bool BMSLib::getSelfDischargeConfig(SelfDischargeConfig& config) {
@@ -427,6 +505,7 @@ bool BMSLib::getSelfDischargeConfig(SelfDischargeConfig& config) {
     return true;
 }
 
+#ifndef BMSLIB_NO_FLOAT
 float BMSLib::getEstimatedSelfDischarge() {
     SelfDischargeConfig config;
     if (!getSelfDischargeConfig(config) || !config.enabled) {
@@ -439,23 +518,24 @@ float BMSLib::getEstimatedSelfDischarge() {
     
     return (config.rate / 10.0f) * tempCoef;  // Return % per day
 }
+#endif
 
-bool BMSLib::setPowerMode(PowerMode mode) {
-    // Cannot enter config mode when setting shutdown
-    if (mode != PowerMode::SHUTDOWN && !enterConfigMode()) {
-        return false;
+int32_t BMSLib::getEstimatedSelfDischarge_inMilliPercent() {
+    SelfDischargeConfig config;
+    if (!getSelfDischargeConfig(config) || !config.enabled) {
+        return 0;
     }
 
-    bool success = writeWord(BMS_REG_POWER_MODE, static_cast<uint16_t>(mode));
-    
-    if (success && mode == PowerMode::SHUTDOWN) {
-        delay(500);  // Allow time for shutdown
-    } else if (success) {
-        delay(100);  // Allow time for mode change
-        exitConfigMode();
-    }
+    // rate is 0.1%/day and temperatureCoef 1%/°C, so in 0.001% units:
+    // rate * 100 * (1 + coef/100 * dT) = rate * 100 + rate * coef * dT_cC / 100
+    int32_t dT = temperatureOffset_cC(readTemperature());
+    int32_t rate = config.rate;
+    return rate * 100 + rate * config.temperatureCoef * dT / 100;
+}
 
-    return success;
+bool BMSLib::setPowerMode(PowerMode mode) {
+    waitOp(_opHandle);
+    return waitOp(setPowerModeAsync(mode));
 }
 
 BMSLib::PowerMode BMSLib::getPowerMode() {
@@ -467,7 +547,7 @@ BMSLib::PowerMode BMSLib::getPowerMode() {
 }
 
 bool BMSLib::configurePowerSaving(const PowerConfig& config) {
-    if (!enterConfigMode()) {
+    if (!beginConfig()) {
         return false;
     }
 
@@ -479,12 +559,11 @@ bool BMSLib::configurePowerSaving(const PowerConfig& config) {
     uint16_t wakeConfig = (config.wakeVoltage & 0xFFF0) | (config.sleepDelay & 0x0F);
     success &= writeWord(BMS_REG_POWER_MODE + 1, wakeConfig);
 
-    exitConfigMode();
-    return success;
+    return endConfig(success);
 }
 
 bool BMSLib::getPowerConfig(PowerConfig& config) {
-    if (!enterConfigMode()) {
+    if (!beginConfig()) {
         return false;
     }
 
@@ -500,8 +579,7 @@ bool BMSLib::getPowerConfig(PowerConfig& config) {
         config.sleepDelay = wakeConfig & 0x0F;
     }
 
-    exitConfigMode();
-    return success;
+    return endConfig(success);
 }
 
 uint16_t BMSLib::getAveragePowerConsumption() {
@@ -514,20 +592,9 @@ uint16_t BMSLib::getAveragePowerConsumption() {
 }
 
 bool BMSLib::getLastChargeTime(DateTime& dateTime) {
-    if (!enterConfigMode()) {
-        return false;
-    }
-
-    // Select State Data class
-    if (!writeWord(BMS_REG_DFCLS, 82) ||     // State class = 82
-        !writeWord(BMS_REG_DFBLK, 0)) {      // First block
-        exitConfigMode();
-        return false;
-    }
-
-    // Read just the date/time values
+    // Read just the date/time values from the State Data class (82)
     uint8_t buffer[4];
-    bool success = readDataFlash(14, buffer, sizeof(buffer));  // Offset 14 for date/time
+    bool success = readShadow(82, 14, buffer, sizeof(buffer));  // Offset 14 for date/time
     
     if (success) {
         // Get raw values
@@ -544,7 +611,6 @@ bool BMSLib::getLastChargeTime(DateTime& dateTime) {
         dateTime.minute = rawTime % 60;
     }
 
-    exitConfigMode();
     return success;
 }
 
@@ -565,20 +631,9 @@ uint16_t BMSLib::getChargeCycles() {
 }
 
 bool BMSLib::getLifetimeStats(LifetimeStats& stats) {
-    if (!enterConfigMode()) {
-        return false;
-    }
-
-    // Select Lifetime Data class
-    if (!writeWord(BMS_REG_DFCLS, 59) ||     // Lifetime Data class = 59
-        !writeWord(BMS_REG_DFBLK, 0)) {      // First block
-        exitConfigMode();
-        return false;
-    }
-
-    // Read lifetime data block
-    uint8_t buffer[32];
-    bool success = readDataFlash(0, buffer, sizeof(buffer));
+    // Read lifetime data block (Lifetime Data class = 59)
+    uint8_t buffer[18];
+    bool success = readShadow(59, 0, buffer, sizeof(buffer));
     
     if (success) {
         // Parse the data according to datasheet
@@ -604,19 +659,11 @@ bool BMSLib::getLifetimeStats(LifetimeStats& stats) {
         stats.lastUpdate.minute = rawTime % 60;
     }
 
-    exitConfigMode();
     return success;
 }
 
 bool BMSLib::resetLifetimeStats() {
-    if (!enterConfigMode()) {
-        return false;
-    }
-
-    // Select Lifetime Data class
-    if (!writeWord(BMS_REG_DFCLS, 59) ||     // Lifetime Data class = 59
-        !writeWord(BMS_REG_DFBLK, 0)) {      // First block
-        exitConfigMode();
+    if (!beginConfig()) {
         return false;
     }
 
@@ -629,21 +676,20 @@ bool BMSLib::resetLifetimeStats() {
     resetBuffer[2] = 0x4A;  // Same for min temp
     resetBuffer[3] = 0x0B;
 
-    bool success = writeDataFlash(0, resetBuffer, sizeof(resetBuffer));
+    // Lifetime Data class = 59
+    bool success = writeShadow(59, 0, resetBuffer, sizeof(resetBuffer)) && flushShadow();
 
-    exitConfigMode();
-    return success;
+    return endConfig(success);
 }
 
 bool BMSLib::getDetailedStatus(DetailedStatus& status) {
-    uint16_t flags, flagsB;
-    
-    // Read status flags
-    if (!readWord(BMS_REG_FLAGS, flags) || 
-        !readWord(BMS_REG_FLAGSB, flagsB)) {
+    StatusSnapshot snapshot;
+    if (!readStatusSnapshot(snapshot)) {
         return false;
     }
 
+    uint16_t flags = snapshot.flags;
+
     // Parse flags according to datasheet
     status.isCharging = (flags & 0x0001) != 0;
     status.isDischarging = (flags & 0x0002) != 0;
@@ -654,27 +700,208 @@ bool BMSLib::getDetailedStatus(DetailedStatus& status) {
     status.sleepEnabled = (flags & 0x0040) != 0;
     status.shutdownRequested = (flags & 0x0080) != 0;
 
-    // Get safety status
-    status.safetyStatus = readSafetyStatus();
+    // Safety status lives in FLAGS
+    status.safetyStatus = flags;
     
     // Get error code from control status
-    uint16_t controlStatus;
-    if (!readWord(BMS_REG_CNTL, controlStatus)) {
-        return false;
-    }
-    status.errorCode = (controlStatus >> 8) & 0xFF;
+    status.errorCode = (snapshot.control >> 8) & 0xFF;
 
-    // Get additional data
-    status.stateOfCharge = readSoC();
+    // SOH sits outside the snapshot window
+    status.stateOfCharge = snapshot.stateOfCharge;
     status.stateOfHealth = readSoH();
-    status.remainingCapacity = readRemainingCapacity();
-    status.fullCapacity = readFullChargeCapacity();
-    status.averageCurrent = readCurrent();
-    status.temperature = readTemperature();
+    status.remainingCapacity = snapshot.remainingCapacity;
+    status.fullCapacity = snapshot.fullCapacity;
+    status.averageCurrent = snapshot.current;
+    status.temperature = snapshot.temperature;
+
+    return true;
+}
+
+bool BMSLib::readStatusSnapshot(StatusSnapshot& snapshot) {
+    // One burst when the Wire buffer holds the window, otherwise word-aligned chunks
+    const uint8_t maxChunk = BMS_WIRE_BUFFER_SIZE & ~1;
+    uint8_t buffer[BMS_SNAPSHOT_LENGTH];
+    uint8_t transactions = 0;
+    for (uint8_t offset = 0; offset < sizeof(buffer); offset += maxChunk) {
+        uint8_t chunk = sizeof(buffer) - offset > maxChunk ? maxChunk : sizeof(buffer) - offset;
+        if (!readBlock(BMS_SNAPSHOT_START + offset, buffer + offset, chunk)) {
+            return false;
+        }
+        cacheStoreBlock(BMS_SNAPSHOT_START + offset, buffer + offset, chunk);
+        transactions++;
+    }
+
+    decodeStatusSnapshot(buffer, snapshot);
+    snapshot.transactions = transactions;
+    snapshot.bytes = 3 * transactions + BMS_SNAPSHOT_LENGTH;
+    notifySnapshotListeners(snapshot);
+    return true;
+}
+
+void BMSLib::decodeStatusSnapshot(const uint8_t* buffer, StatusSnapshot& snapshot) {
+    // Offsets are relative to BMS_SNAPSHOT_START. Voltage, current and temperature get
+    // the same range checks as the individual readers and read as 0 when implausible
+    uint16_t value;
+    decodeField(Field::CONTROL, buffer + BMS_REG_CNTL, snapshot.control);
+    decodeField(Field::STATE_OF_CHARGE, buffer + BMS_REG_SOC, value);
+    snapshot.stateOfCharge = value;
+    decodeField(Field::MAX_ERROR, buffer + BMS_REG_ME, value);
+    snapshot.maxError = value;
+    decodeField(Field::REMAINING_CAPACITY, buffer + BMS_REG_RM, snapshot.remainingCapacity);
+    decodeField(Field::FULL_CAPACITY, buffer + BMS_REG_FCC, snapshot.fullCapacity);
+    decodeField(Field::VOLTAGE, buffer + BMS_REG_VOLT, snapshot.voltage);
+    decodeField(Field::AVERAGE_CURRENT, buffer + BMS_REG_AI, value);
+    snapshot.averageCurrent = static_cast<int16_t>(value);
+    decodeField(Field::TEMPERATURE, buffer + BMS_REG_TEMP, snapshot.temperature);
+    decodeField(Field::FLAGS, buffer + BMS_REG_FLAGS, snapshot.flags);
+    decodeField(Field::CURRENT, buffer + BMS_REG_CURRENT, value);
+    snapshot.current = static_cast<int16_t>(value);
+    decodeField(Field::FLAGSB, buffer + BMS_REG_FLAGSB, snapshot.flagsB);
+
+    // Alarms need the readings the range checks reject, so keep the register words too
+    snapshot.rawVoltage = buffer[BMS_REG_VOLT] | (buffer[BMS_REG_VOLT + 1] << 8);
+    snapshot.rawCurrent = static_cast<int16_t>(buffer[BMS_REG_CURRENT] | (buffer[BMS_REG_CURRENT + 1] << 8));
+    snapshot.rawTemperature = buffer[BMS_REG_TEMP] | (buffer[BMS_REG_TEMP + 1] << 8);
+
+    // One burst read: 2x address, command, data
+    snapshot.transactions = 1;
+    snapshot.bytes = 3 + BMS_SNAPSHOT_LENGTH;
+}
+
+void BMSLib::notifySnapshotListeners(const StatusSnapshot& snapshot) {
+#if BMS_SNAPSHOT_LISTENERS > 0
+    for (uint8_t i = 0; i < BMS_SNAPSHOT_LISTENERS; i++) {
+        if (_listeners[i].listener != nullptr) {
+            _listeners[i].listener(snapshot, _listeners[i].context);
+        }
+    }
+#else
+    (void)snapshot;
+#endif
+}
+
+bool BMSLib::addSnapshotListener(SnapshotListener listener, void* context) {
+#if BMS_SNAPSHOT_LISTENERS > 0
+    for (uint8_t i = 0; i < BMS_SNAPSHOT_LISTENERS; i++) {
+        if (_listeners[i].listener == nullptr) {
+            _listeners[i].listener = listener;
+            _listeners[i].context = context;
+            return true;
+        }
+    }
+#else
+    (void)listener;
+    (void)context;
+#endif
+    return false;
+}
+
+void BMSLib::removeSnapshotListener(SnapshotListener listener, void* context) {
+#if BMS_SNAPSHOT_LISTENERS > 0
+    for (uint8_t i = 0; i < BMS_SNAPSHOT_LISTENERS; i++) {
+        if (_listeners[i].listener == listener && _listeners[i].context == context) {
+            _listeners[i].listener = nullptr;
+            _listeners[i].context = nullptr;
+        }
+    }
+#else
+    (void)listener;
+    (void)context;
+#endif
+}
+
+bool BMSLib::compileReadPlan(uint32_t fields, ReadPlan& plan, uint8_t maxGap) {
+    plan.rangeCount = 0;
+    plan.fields = fields;
+
+    // FIELD_INFO is sorted by address, so one pass yields ascending ranges
+    ReadPlan::Range* current = nullptr;
+    for (uint8_t i = 0; i < static_cast<uint8_t>(Field::COUNT); i++) {
+        if ((fields & (1UL << i)) == 0) {
+            continue;
+        }
+
+        uint8_t start = FIELD_INFO[i].reg;
+        uint8_t end = start + fieldWidth(i);
+
+        // Extend the open range if the gap is cheap and the read still fits the Wire buffer
+        if (current != nullptr) {
+            uint8_t currentEnd = current->start + current->length;
+            if (start <= currentEnd + maxGap &&
+                end - current->start <= BMS_WIRE_BUFFER_SIZE) {
+                current->length = end - current->start;
+                continue;
+            }
+        }
+
+        if (plan.rangeCount >= BMS_READ_PLAN_MAX_RANGES) {
+            return false;
+        }
+        current = &plan.ranges[plan.rangeCount++];
+        current->start = start;
+        current->length = end - start;
+    }
 
     return true;
 }
 
+bool BMSLib::executeReadPlan(const ReadPlan& plan, FieldValues& values) {
+    uint8_t buffer[BMS_WIRE_BUFFER_SIZE];
+    uint8_t field = 0;
+
+    values.valid = 0;
+    for (uint8_t r = 0; r < plan.rangeCount; r++) {
+        const ReadPlan::Range& range = plan.ranges[r];
+        if (!readBlock(range.start, buffer, range.length)) {
+            return false;
+        }
+        cacheStoreBlock(range.start, buffer, range.length);
+
+        // Decode every planned field that falls inside this range
+        for (; field < static_cast<uint8_t>(Field::COUNT); field++) {
+            if (FIELD_INFO[field].reg < range.start) {
+                continue;
+            }
+            uint8_t offset = FIELD_INFO[field].reg - range.start;
+            if (offset + fieldWidth(field) > range.length) {
+                break;
+            }
+            if ((plan.fields & (1UL << field)) == 0) {
+                continue;
+            }
+
+            uint16_t value = buffer[offset];
+            if (fieldWidth(field) == 2) {
+                value |= buffer[offset + 1] << 8;
+            }
+            values.values[field] = value;
+            values.valid |= 1UL << field;
+        }
+    }
+
+    return true;
+}
+
+bool BMSLib::readFields(uint32_t fields, FieldValues& values) {
+    ReadPlan plan;
+    if (!compileReadPlan(fields, plan)) {
+        return false;
+    }
+    return executeReadPlan(plan, values);
+}
+
+const BMSLib::BusStats& BMSLib::getBusStats() const {
+    return _busStats;
+}
+
+void BMSLib::resetBusStats() {
+    _busStats.transactions = 0;
+    _busStats.bytes = 0;
+    _busStats.errors = 0;
+    _busStats.retries = 0;
+    _busStats.recoveries = 0;
+}
+
 bool BMSLib::sleep() {
     if (_configMode) {
         exitConfigMode();
@@ -683,11 +910,8 @@ bool BMSLib::sleep() {
 }
 
 bool BMSLib::wake() {
-    bool success = writeWord(BMS_REG_CNTL, BMS_WAKE_COMMAND);
-    if (success) {
-        delay(100);
-    }
-    return success;
+    waitOp(_opHandle);
+    return waitOp(wakeAsync());
 }
 
 bool BMSLib::resetWatchdog() {
@@ -695,40 +919,137 @@ bool BMSLib::resetWatchdog() {
 }
 
 bool BMSLib::enterConfigMode() {
-    if (_configMode) return true;
-    
-    if (!writeWord(BMS_REG_CNTL, BMS_CONFIG_MODE_ENTER)) {
-        return false;
-    }
-    
-    delay(100);
-    _configMode = true;
-    return true;
+    waitOp(_opHandle);
+    return waitOp(enterConfigModeAsync());
 }
 
 bool BMSLib::exitConfigMode() {
-    if (!_configMode) return true;
-    
-    if (!writeWord(BMS_REG_CNTL, BMS_CONFIG_MODE_EXIT)) {
-        return false;
+    waitOp(_opHandle);
+    return waitOp(exitConfigModeAsync());
+}
+
+bool BMSLib::beginConfig() {
+    // Only the outermost scope toggles the mode; one entered by the caller is left alone
+    if (_configDepth == 0) {
+        _configScoped = !_configMode;
+        if (_configScoped && !enterConfigMode()) {
+            if (_session != nullptr) {
+                _session->_failed = true;
+            }
+            return false;
+        }
     }
-    
-    delay(100);
-    _configMode = false;
+
+    _configDepth++;
     return true;
 }
 
-bool BMSLib::factoryReset() {
-    if (_configMode) {
-        exitConfigMode();
+bool BMSLib::endConfig(bool success) {
+    if (!success && _session != nullptr) {
+        _session->_failed = true;
     }
-    
-    if (!writeWord(BMS_REG_CNTL, BMS_FACTORY_RESET)) {
+
+    if (_configDepth > 0 && --_configDepth == 0 && _configScoped) {
+        _configScoped = false;
+        if (!exitConfigMode()) {
+            return false;
+        }
+    }
+    return success;
+}
+
+BMSLib::ConfigSession::ConfigSession(BMSLib& bms, bool rollbackOnFailure) :
+    _bms(bms),
+    _owner(bms._session == nullptr),
+    _active(false),
+    _failed(false),
+    _closed(false),
+    _rollback(rollbackOnFailure),
+    _journalCount(0) {
+    // Nested sessions join the outermost one, which owns commit and rollback
+    if (_owner) {
+        _bms._session = this;
+    }
+    _active = _bms.beginConfig();
+    if (!_active) {
+        _failed = true;
+    }
+}
+
+BMSLib::ConfigSession::~ConfigSession() {
+    if (!_closed) {
+        abort();
+        close();
+    }
+}
+
+bool BMSLib::ConfigSession::ok() const {
+    const ConfigSession* root = _owner ? this : _bms._session;
+    return _active && !_failed && (root == nullptr || !root->_failed);
+}
+
+bool BMSLib::ConfigSession::commit() {
+    if (_closed) {
         return false;
     }
-    
-    delay(500);
-    return isOnline();
+    bool success = ok();
+    close();
+    return success;
+}
+
+void BMSLib::ConfigSession::abort() {
+    _failed = true;
+    if (!_owner && _bms._session != nullptr) {
+        _bms._session->_failed = true;
+    }
+}
+
+void BMSLib::ConfigSession::record(uint8_t command) {
+    for (uint8_t i = 0; i < _journalCount; i++) {
+        if (_journal[i].command == command) {
+            return;  // Only the value from before the session matters
+        }
+    }
+    if (_journalCount >= BMS_CONFIG_JOURNAL_SIZE) {
+        return;
+    }
+
+    uint16_t value;
+    if (_bms.readWord(command, value)) {
+        _journal[_journalCount].command = command;
+        _journal[_journalCount].value = value;
+        _journalCount++;
+    }
+}
+
+void BMSLib::ConfigSession::close() {
+    _closed = true;
+    if (!_active) {
+        if (_owner) {
+            _bms._session = nullptr;
+        }
+        return;
+    }
+
+    if (_owner) {
+        // Restore journaled registers in reverse order before leaving config mode
+        if (_failed && _rollback) {
+            _rollback = false;
+            while (_journalCount > 0) {
+                _journalCount--;
+                _bms.writeWord(_journal[_journalCount].command, _journal[_journalCount].value);
+            }
+            // Unflushed shadow writes belong to the failed session too
+            _bms.invalidateShadow();
+        }
+        _bms._session = nullptr;
+    }
+    _bms.endConfig(!_failed);
+}
+
+bool BMSLib::factoryReset() {
+    waitOp(_opHandle);
+    return waitOp(factoryResetAsync());
 }
 
 bool BMSLib::isOverVoltage() {
@@ -751,42 +1072,122 @@ bool BMSLib::isOverTemperature() {
     return (status & 0x0008) != 0;
 }
 
+bool BMSLib::selectDataFlashBlock(uint8_t subclass, uint8_t block) {
+    // Enable block access, then write class and block index in one transaction
+    uint8_t control = 0x00;
+    uint8_t selection[2] = { subclass, block };
+    if (!writeBlock(BMS_REG_BLOCKDATA_CTRL, &control, 1) ||
+        !writeBlock(BMS_REG_DFCLS, selection, sizeof(selection))) {
+        return false;
+    }
+
+    _dfClass = subclass;
+    _dfBlock = block;
+    return true;
+}
+
 bool BMSLib::readDataFlash(uint8_t offset, uint8_t* data, uint8_t length) {
-    if (!_configMode) {
+    if (!_configMode || offset + length > BMS_DATAFLASH_BLOCK_SIZE) {
         return false;
     }
 
-    for (uint8_t i = 0; i < length; i++) {
-        _wire->beginTransmission(BMS_I2C_ADDRESS);
-        _wire->write(0x40 + offset + i);  // Data flash starts at 0x40
-        if (_wire->endTransmission(false) != 0) {
+    // Burst-read the BlockData window, chunked to the Wire buffer
+    while (length > 0) {
+        uint8_t chunk = length > BMS_WIRE_BUFFER_SIZE ? BMS_WIRE_BUFFER_SIZE : length;
+        if (!readBlock(BMS_REG_BLOCKDATA + offset, data, chunk)) {
             return false;
         }
-        
-        if (_wire->requestFrom(BMS_I2C_ADDRESS, (uint8_t)1) != 1) {
-            return false;
-        }
-        
-        data[i] = _wire->read();
+        offset += chunk;
+        data += chunk;
+        length -= chunk;
     }
     
     return true;
 }
 
 bool BMSLib::writeDataFlash(uint8_t offset, const uint8_t* data, uint8_t length) {
-    if (!_configMode) {
+    if (!_configMode || offset + length > BMS_DATAFLASH_BLOCK_SIZE) {
         return false;
     }
 
+    // The checksum covers the whole block, so start from its current contents
+    uint8_t block[BMS_DATAFLASH_BLOCK_SIZE];
+    if (!readDataFlash(0, block, sizeof(block))) {
+        return false;
+    }
+
+    // Only the bytes that actually change need to go over the bus
+    uint8_t from = BMS_DATAFLASH_BLOCK_SIZE;
+    uint8_t to = 0;
     for (uint8_t i = 0; i < length; i++) {
-        _wire->beginTransmission(BMS_I2C_ADDRESS);
-        _wire->write(0x40 + offset + i);
-        _wire->write(data[i]);
-        if (_wire->endTransmission() != 0) {
+        if (block[offset + i] != data[i]) {
+            block[offset + i] = data[i];
+            if (from > offset + i) from = offset + i;
+            to = offset + i + 1;
+        }
+    }
+
+    if (from >= to) {
+        return true;  // Already up to date
+    }
+    return commitDataFlash(block, from, to);
+}
+
+bool BMSLib::commitDataFlash(const uint8_t* block, uint8_t from, uint8_t to) {
+    // Each write carries the command byte, so one less data byte fits the buffer
+    const uint8_t maxChunk = BMS_WIRE_BUFFER_SIZE - 1;
+    while (from < to) {
+        uint8_t chunk = (to - from) > maxChunk ? maxChunk : (to - from);
+        if (!writeBlock(BMS_REG_BLOCKDATA + from, block + from, chunk)) {
             return false;
         }
+        from += chunk;
     }
-    
+
+    // Writing the checksum commits the block to flash
+    uint8_t checksum = dataFlashChecksum(block);
+    if (!writeBlock(BMS_REG_BLOCKDATA_CKSUM, &checksum, 1)) {
+        return false;
+    }
+
+    // Re-selecting reloads the block from flash; its checksum must match
+    uint8_t verify;
+    if (!selectDataFlashBlock(_dfClass, _dfBlock) ||
+        !readBlock(BMS_REG_BLOCKDATA_CKSUM, &verify, 1)) {
+        return false;
+    }
+    return verify == checksum;
+}
+
+uint8_t BMSLib::dataFlashChecksum(const uint8_t* block) {
+    uint8_t sum = 0;
+    for (uint8_t i = 0; i < BMS_DATAFLASH_BLOCK_SIZE; i++) {
+        sum += block[i];
+    }
+    return 0xFF - sum;
+}
+
+bool BMSLib::readDataFlashBlock(uint8_t subclass, uint8_t block, uint8_t* data) {
+    uint8_t checksum;
+    if (!_configMode ||
+        !selectDataFlashBlock(subclass, block) ||
+        !readDataFlash(0, data, BMS_DATAFLASH_BLOCK_SIZE) ||
+        !readBlock(BMS_REG_BLOCKDATA_CKSUM, &checksum, 1)) {
+        return false;
+    }
+
+    // Reject blocks corrupted in transit
+    return checksum == dataFlashChecksum(data);
+}
+
+bool BMSLib::writeDataFlashBlock(uint8_t subclass, uint8_t block, const uint8_t* data) {
+    if (!_configMode || !selectDataFlashBlock(subclass, block) ||
+        !commitDataFlash(data, 0, BMS_DATAFLASH_BLOCK_SIZE)) {
+        return false;
+    }
+
+    // Keep any shadow copy of this block in step with the gauge
+    shadowUpdate(subclass, block, data);
     return true;
 }
 
@@ -798,10 +1199,34 @@ bool BMSLib::isInSleepMode() {
     return (status & BMS_STATUS_SLEEP) != 0;
 }
 
+#ifndef BMSLIB_NO_FLOAT
 float BMSLib::compensateTemperature(float voltage, float temperature) {
     float tempDiff = temperature - 25.0f;  // Difference from room temperature
     return voltage * (1.0f + (tempDiff * TEMP_COEFFICIENT));
 }
+#endif
+
+uint16_t BMSLib::compensateTemperature_mV(uint16_t millivolts, uint16_t temperature) {
+    static_assert(100000000L % TEMP_COEFFICIENT_PPM == 0, "coefficient must divide 1e8");
+    static constexpr int32_t DIVISOR = 100000000L / TEMP_COEFFICIENT_PPM;
+
+    // mV * dT(0.01°C) * ppm / 1e8; |dT| is clamped so the product fits in 32 bits
+    int32_t product = static_cast<int32_t>(millivolts) * temperatureOffset_cC(temperature);
+    int32_t correction = (product + (product >= 0 ? DIVISOR / 2 : -DIVISOR / 2)) / DIVISOR;
+    int32_t result = static_cast<int32_t>(millivolts) + correction;
+    return result < 0 ? 0 : (result > 0xFFFF ? 0xFFFF : static_cast<uint16_t>(result));
+}
+
+int32_t BMSLib::temperatureOffset_cC(uint16_t temperature) {
+    // 0.1K to 0.01K, relative to 25°C, clamped to ±327°C
+    int32_t offset = static_cast<int32_t>(temperature) * 10 - TEMP_REFERENCE_CK;
+    return offset > 32767 ? 32767 : (offset < -32767 ? -32767 : offset);
+}
+
+uint16_t BMSLib::calibrationGain(int32_t actual, int32_t measured) {
+    // actual / measured with 3 decimals, truncated like the original float cast
+    return static_cast<uint16_t>(actual * 1000 / measured);
+}
 
 bool BMSLib::validateTemperature(uint16_t temp) {
     return (temp >= 2731 && temp <= MAX_TEMPERATURE);
@@ -814,11 +1239,3 @@ bool BMSLib::validateVoltage(uint16_t voltage) {
 bool BMSLib::validateCurrent(int16_t current) {
     return (current >= -MAX_CURRENT && current <= MAX_CURRENT);
 }
-
-uint16_t BMSLib::readSafetyStatus() {
-    uint16_t value;
-    if (!readWord(BMS_REG_FLAGS, value)) {
-        return 0;
-    }
-    return value;
-}
\ No newline at end of file
@@ -2,7 +2,19 @@
 #define BMSLIB_H
 
 #include <Arduino.h>
+
+// I2C backend. Defaults to Arduino TwoWire. Any class with the same transaction subset
+// (begin, beginTransmission, write, endTransmission, requestFrom, available, read) can
+// be used instead by defining BMS_BUS_CLASS and BMS_BUS_HEADER as build flags. Calls
+// bind at compile time, so a backend costs no virtual dispatch and can be inlined.
+#ifdef BMS_BUS_HEADER
+#include BMS_BUS_HEADER
+#endif
+#ifndef BMS_BUS_CLASS
 #include <Wire.h>
+#define BMS_BUS_CLASS           TwoWire
+#define BMS_BUS_WIRE                    // Platform Wire extensions (timeouts, pins) available
+#endif
 
 // Version information
 #define BMSLIB_VERSION_MAJOR 1
@@ -43,6 +55,24 @@
 #define BMS_REG_DFCLS           0x3E    // Data Flash Class
 #define BMS_REG_DFBLK           0x3F    // Data Flash Block
 
+// Data Flash Block Access
+#define BMS_REG_BLOCKDATA       0x40    // BlockData window (0x40-0x5F)
+#define BMS_REG_BLOCKDATA_CKSUM 0x60    // BlockDataChecksum
+#define BMS_REG_BLOCKDATA_CTRL  0x61    // BlockDataControl
+#define BMS_DATAFLASH_BLOCK_SIZE 32
+
+// Image records hashed individually by a fingerprint; later records share the last slot
+#ifndef BMS_FINGERPRINT_SECTIONS
+#define BMS_FINGERPRINT_SECTIONS 16
+#endif
+
+// Golden image records: subclass, offset, length, then the bytes. A record whose
+// subclass is BMS_IMAGE_REGISTER writes a standard command (offset = command code)
+#define BMS_IMAGE_REGISTER      0xFF
+#define BMS_IMAGE_DF(subclass, offset, length)  (subclass), (offset), (length)
+#define BMS_IMAGE_REG(command, value) \
+    BMS_IMAGE_REGISTER, (command), 2, ((value) & 0xFF), (((value) >> 8) & 0xFF)
+
 // Calibration Registers
 #define BMS_REG_VOLTAGE_CAL     0x0D
 #define BMS_REG_CURRENT_CAL     0x0E
@@ -68,6 +98,74 @@
 // Status bits
 #define BMS_STATUS_SLEEP        0x0002  // Sleep mode status bit
 
+// Registers a rollback-enabled config session can restore
+#ifndef BMS_CONFIG_JOURNAL_SIZE
+#define BMS_CONFIG_JOURNAL_SIZE 8
+#endif
+
+// Steps a single non-blocking operation can hold
+#ifndef BMS_ASYNC_MAX_STEPS
+#define BMS_ASYNC_MAX_STEPS     6
+#endif
+
+// Read cache (0 compiles the cache out)
+#ifndef BMS_READ_CACHE_ENTRIES
+#define BMS_READ_CACHE_ENTRIES  8
+#endif
+#define BMS_CACHE_TTL_NONE      0       // Never cached
+#define BMS_CACHE_TTL_STATIC    0xFFFF  // Cached until a write invalidates it
+
+// Data flash blocks held in RAM by the shadow image (0 compiles it out). One block is
+// enough for the library's own setters; writes spread over more blocks before a
+// flushShadow() need one each, or evictions flush them early
+#ifndef BMS_SHADOW_BLOCKS
+#define BMS_SHADOW_BLOCKS       2
+#endif
+
+// Transport defaults: per-transaction timeout, extra attempts, first retry delay
+#ifndef BMS_TRANSPORT_TIMEOUT_US
+#define BMS_TRANSPORT_TIMEOUT_US    25000
+#endif
+#ifndef BMS_TRANSPORT_RETRIES
+#define BMS_TRANSPORT_RETRIES       2
+#endif
+#ifndef BMS_TRANSPORT_BACKOFF_US
+#define BMS_TRANSPORT_BACKOFF_US    1000
+#endif
+
+// Callbacks notified after every status snapshot (0 compiles the hook out)
+#ifndef BMS_SNAPSHOT_LISTENERS
+#define BMS_SNAPSHOT_LISTENERS  2
+#endif
+
+// Define BMSLIB_NO_FLOAT (as a build flag) to drop the float unit conversions and
+// keep only the integer API, so no soft-float code is linked on FPU-less targets
+
+// Burst snapshot window (CNTL through FLAGSB, auto-incrementing read)
+#define BMS_SNAPSHOT_START      BMS_REG_CNTL
+#define BMS_SNAPSHOT_LENGTH     20
+
+// Largest single read the platform Wire buffer can hold
+#ifndef BMS_WIRE_BUFFER_SIZE
+#if defined(I2C_BUFFER_LENGTH)
+#define BMS_WIRE_BUFFER_SIZE    I2C_BUFFER_LENGTH
+#elif defined(BUFFER_LENGTH)
+#define BMS_WIRE_BUFFER_SIZE    BUFFER_LENGTH
+#else
+#define BMS_WIRE_BUFFER_SIZE    32
+#endif
+#endif
+
+// Read plan limits
+#ifndef BMS_READ_PLAN_MAX_RANGES
+#define BMS_READ_PLAN_MAX_RANGES 8
+#endif
+#ifndef BMS_READ_PLAN_MAX_GAP
+#define BMS_READ_PLAN_MAX_GAP   4       // Unused bytes worth reading to save a transaction
+#endif
+
+typedef BMS_BUS_CLASS BMSBus;
+
 class BMSLib {
 public:
     // DateTime structure
@@ -124,14 +222,125 @@ public:
         bool shutdownRequested;  // Shutdown was requested
         uint8_t errorCode;       // Last error code
         uint16_t safetyStatus;   // Safety alert flags
+#ifdef BMSLIB_NO_FLOAT
+        uint8_t stateOfCharge;   // Current SOC (%)
+        uint8_t stateOfHealth;   // Current SOH (%)
+#else
         float stateOfCharge;     // Current SOC (%)
         float stateOfHealth;     // Current SOH (%)
+#endif
         uint16_t remainingCapacity; // Remaining capacity (mAh)
         uint16_t fullCapacity;     // Full charge capacity (mAh)
         int16_t averageCurrent;    // Average current (mA)
         uint16_t temperature;      // Current temperature (0.1°K)
     };
 
+    // Burst Status Snapshot (decoded from one read of the standard command window)
+    struct StatusSnapshot {
+        uint16_t control;          // Control status word
+        uint16_t remainingCapacity; // Remaining capacity (mAh)
+        uint16_t fullCapacity;     // Full charge capacity (mAh)
+        uint16_t voltage;          // Pack voltage (mV), 0 if out of range
+        int16_t averageCurrent;    // Average current (mA)
+        uint16_t temperature;      // Temperature (0.1°K), 0 if out of range
+        uint16_t flags;            // FLAGS register
+        int16_t current;           // Instantaneous current (mA), 0 if out of range
+        uint16_t flagsB;           // FLAGSB register
+        uint8_t stateOfCharge;     // SOC (%)
+        uint8_t maxError;          // Max error (%)
+        uint16_t rawVoltage;       // Register values before the range checks, for
+        int16_t rawCurrent;        // consumers that must see out-of-range readings
+        uint16_t rawTemperature;   // (alarms, statistics)
+        uint8_t transactions;      // I2C transactions used for this snapshot
+        uint8_t bytes;             // I2C bytes transferred for this snapshot
+    };
+
+    // Read cache counters
+    struct CacheStats {
+        uint32_t hits;             // Reads served from RAM
+        uint32_t misses;           // Cacheable reads that went to the bus
+    };
+
+    // Golden image outcome; for compareImage() the "changed" counts are pending changes
+    struct ImageResult {
+        uint8_t blocksChecked;     // Data flash blocks read and compared
+        uint8_t blocksChanged;     // Blocks that differed from the image
+        uint8_t registersChanged;  // Register records that differed
+        uint16_t bytesWritten;     // Bytes sent, diff ranges only
+        uint32_t elapsedMs;        // Including config mode entry and exit
+    };
+
+    // Hash of the bytes an image covers, as a whole and per record (section)
+    struct Fingerprint {
+        uint32_t hash;             // FNV-1a over every record
+        uint16_t sections[BMS_FINGERPRINT_SECTIONS];
+        uint8_t count;             // Sections in use
+    };
+
+    // Fields addressable by a read plan, in register address order
+    enum class Field : uint8_t {
+        CONTROL,                // BMS_REG_CNTL
+        STATE_OF_CHARGE,        // BMS_REG_SOC (1 byte)
+        MAX_ERROR,              // BMS_REG_ME (1 byte)
+        REMAINING_CAPACITY,     // BMS_REG_RM
+        FULL_CAPACITY,          // BMS_REG_FCC
+        VOLTAGE,                // BMS_REG_VOLT
+        AVERAGE_CURRENT,        // BMS_REG_AI
+        TEMPERATURE,            // BMS_REG_TEMP
+        FLAGS,                  // BMS_REG_FLAGS
+        CURRENT,                // BMS_REG_CURRENT
+        FLAGSB,                 // BMS_REG_FLAGSB
+        AVERAGE_TIME_TO_EMPTY,  // BMS_REG_ATTE
+        AVERAGE_TIME_TO_FULL,   // BMS_REG_ATTF
+        PASSED_CHARGE,          // BMS_REG_PCHG
+        DOD0_TIME,              // BMS_REG_DOD0T
+        AVAILABLE_ENERGY,       // BMS_REG_AE
+        AVERAGE_POWER,          // BMS_REG_AP
+        SERIAL_NUMBER,          // BMS_REG_SERNUM
+        INTERNAL_TEMPERATURE,   // BMS_REG_INTTEMP
+        CYCLE_COUNT,            // BMS_REG_CC
+        STATE_OF_HEALTH,        // BMS_REG_SOH
+        CHARGE_VOLTAGE,         // BMS_REG_CHGV
+        CHARGE_CURRENT,         // BMS_REG_CHGI
+        PACK_CONFIG,            // BMS_REG_PKCFG
+        DESIGN_CAPACITY,        // BMS_REG_DCAP
+        COUNT
+    };
+
+    static constexpr uint32_t fieldMask(Field field) {
+        return 1UL << static_cast<uint8_t>(field);
+    }
+
+    // Precomputed set of burst reads covering a field mask
+    struct ReadPlan {
+        struct Range {
+            uint8_t start;         // First command code
+            uint8_t length;        // Bytes to read
+        };
+        Range ranges[BMS_READ_PLAN_MAX_RANGES];
+        uint8_t rangeCount;        // Burst reads (transactions) per execution
+        uint32_t fields;           // Field mask the plan covers
+    };
+
+    // Raw register values produced by executing a read plan
+    struct FieldValues {
+        uint16_t values[static_cast<uint8_t>(Field::COUNT)];
+        uint32_t valid;            // Mask of fields decoded by the last execution
+
+        bool has(Field field) const { return (valid & fieldMask(field)) != 0; }
+        uint16_t get(Field field) const { return values[static_cast<uint8_t>(field)]; }
+        int16_t getSigned(Field field) const { return static_cast<int16_t>(get(field)); }
+    };
+
+    // Bus traffic counters
+    struct BusStats {
+        uint32_t transactions;     // Completed command/read or command/write cycles
+        uint32_t bytes;            // Bytes on the wire, including address and command
+        uint32_t errors;           // Failed attempts, including ones a retry recovered
+        uint32_t retries;          // Attempts repeated after a failure
+        uint32_t recoveries;       // SCL clock-pulse bus recoveries
+    };
+
     // Battery Chemistry Types
     enum class BatteryChemistry {
         LION     = 0x0100,  // Lithium Ion
@@ -173,35 +382,149 @@ public:
         uint8_t reserveCapacity;    // Reserve capacity percentage
     };
 
+    // Non-blocking operation state
+    enum class OpState : uint8_t {
+        IDLE,       // No operation with this handle
+        PENDING,    // Waiting for the gauge to settle; call poll()
+        DONE,       // Completed successfully
+        FAILED      // A step failed; config mode was restored
+    };
+
+    typedef uint8_t OpHandle;  // 0 means the operation was rejected
+
+    // Outcome of the most recent bus call
+    enum class Status : uint8_t {
+        OK,
+        NACK_ADDRESS,       // Gauge absent, or busy (e.g. during a flash write)
+        NACK_DATA,          // Command or data byte rejected
+        TIMEOUT,            // Transaction exceeded the Wire timeout
+        SHORT_READ,         // Fewer bytes returned than requested
+        BUS_ERROR,          // Arbitration loss or other controller error
+        BUS_STUCK,          // SDA held low and recovery did not release it
+        INVALID_ARGUMENT,   // Transfer larger than the Wire buffer
+        OUT_OF_RANGE,       // Read succeeded but the value failed validation
+        BUSY                // A split-phase read is already in flight
+    };
+
+    // Bounded-latency transport. Worst case per call is about
+    // (retries + 1) * timeoutUs + backoffUs * (2^retries - 1), plus recovery pulses.
+    struct TransportConfig {
+        // Per-transaction Wire timeout, 0 keeps the core default. Applied on AVR/megaAVR,
+        // ESP32 and ESP8266 only: the SAMD, RP2040 and STM32 cores have no Wire timeout
+        // call, so there a stalled transfer is bounded only by the core itself
+        uint32_t timeoutUs;
+        uint8_t retries;           // Extra attempts after a failure
+        uint16_t backoffUs;        // First retry delay, doubled on each attempt
+        int8_t sdaPin;             // Pins for SCL-pulse bus recovery, -1 disables it
+        int8_t sclPin;
+        uint32_t clockHz;          // Bus clock, set now and again after recovery; 0 leaves it alone
+    };
+
+    // Scoped config mode: enters once, every setter inside reuses it, exits on commit
+    // or destruction. With rollbackOnFailure, word registers written during the session
+    // are restored if any operation fails or the session is not committed.
+    class ConfigSession {
+    public:
+        explicit ConfigSession(BMSLib& bms, bool rollbackOnFailure = false);
+        ~ConfigSession();
+
+        bool active() const { return _active; }  // Config mode was entered
+        bool ok() const;                          // No operation has failed so far
+        bool commit();                            // Leave config mode, returns ok()
+        void abort();                             // Mark failed; rollback on close
+
+    private:
+        friend class BMSLib;
+
+        struct JournalEntry {
+            uint8_t command;
+            uint16_t value;
+        };
+
+        BMSLib& _bms;
+        bool _owner;
+        bool _active;
+        bool _failed;
+        bool _closed;
+        bool _rollback;
+        uint8_t _journalCount;
+        JournalEntry _journal[BMS_CONFIG_JOURNAL_SIZE];
+
+        void record(uint8_t command);
+        void close();
+
+        ConfigSession(const ConfigSession&) = delete;
+        ConfigSession& operator=(const ConfigSession&) = delete;
+    };
+
     // Constructor/Destructor
-    BMSLib(TwoWire &wirePort = Wire);
+#ifdef BMS_BUS_WIRE
+    BMSLib(BMSBus &wirePort = Wire, uint8_t address = BMS_I2C_ADDRESS);
+#else
+    BMSLib(BMSBus &wirePort, uint8_t address = BMS_I2C_ADDRESS);
+#endif
     ~BMSLib();
 
     // Basic functions
     bool begin();
+    // Also brings the unit in line with a golden image, writing nothing when the
+    // fingerprints match; differing gets one bit per image record that was rewritten
+    bool begin(const uint8_t* image, uint16_t length, uint32_t* differing = nullptr);
     void getVersion(uint8_t &major, uint8_t &minor, uint8_t &patch);
     bool isOnline();
-
-    // Raw data reading functions
-    uint16_t readVoltage();            // Returns millivolts
-    int16_t readCurrent();             // Returns milliamps
-    uint16_t readCapacity();           // Returns mAh
-    uint16_t readTemperature();        // Returns 0.1K
-    uint16_t readSoC();                // Returns percentage (0-100%)
-    uint16_t readSoH();                // Returns percentage (0-100%)
-    uint16_t readCycleCount();         // Returns cycle count
-    uint16_t readDesignCapacity();     // Returns mAh
-    uint16_t readFullChargeCapacity(); // Returns mAh
-    uint16_t readRemainingCapacity();  // Returns mAh
-    uint16_t readSafetyStatus();       // Returns safety status flags
+    BMSBus& getWire() const;
+    uint8_t getAddress() const;
+
+    // Raw data reading functions, decoded from the register descriptor table.
+    // Each returns 0 on failure; getLastStatus() tells it from a real zero
+    uint16_t readVoltage()            { return readFieldOrZero(Field::VOLTAGE); }  // Returns millivolts
+    int16_t readCurrent()             { return static_cast<int16_t>(readFieldOrZero(Field::CURRENT)); }  // Returns milliamps
+    uint16_t readCapacity()           { return readFieldOrZero(Field::REMAINING_CAPACITY); }  // Returns mAh
+    uint16_t readTemperature()        { return readFieldOrZero(Field::TEMPERATURE); }  // Returns 0.1K
+    uint16_t readSoC()                { return readFieldOrZero(Field::STATE_OF_CHARGE); }  // Returns percentage (0-100%)
+    uint16_t readSoH()                { return readFieldOrZero(Field::STATE_OF_HEALTH); }  // Returns percentage (0-100%)
+    uint16_t readCycleCount()         { return readFieldOrZero(Field::CYCLE_COUNT); }  // Returns cycle count
+    uint16_t readDesignCapacity()     { return readFieldOrZero(Field::DESIGN_CAPACITY); }  // Returns mAh
+    uint16_t readFullChargeCapacity() { return readFieldOrZero(Field::FULL_CAPACITY); }  // Returns mAh
+    uint16_t readRemainingCapacity()  { return readFieldOrZero(Field::REMAINING_CAPACITY); }  // Returns mAh
+    uint16_t readSafetyStatus()       { return readFieldOrZero(Field::FLAGS); }  // Returns safety status flags
+
+    // Extended registers
+    uint8_t getMaxError()             { return static_cast<uint8_t>(readFieldOrZero(Field::MAX_ERROR)); }  // Percent
+    uint16_t getAverageTimeToEmpty()  { return readFieldOrZero(Field::AVERAGE_TIME_TO_EMPTY); }  // Minutes, 65535 when not discharging
+    uint16_t getAverageTimeToFull()   { return readFieldOrZero(Field::AVERAGE_TIME_TO_FULL); }  // Minutes, 65535 when not charging
+    int16_t getPassedCharge()         { return static_cast<int16_t>(readFieldOrZero(Field::PASSED_CHARGE)); }  // mAh since the last OCV reading
+    uint16_t getDoD0Time()            { return readFieldOrZero(Field::DOD0_TIME); }  // Minutes since the last OCV reading
+    uint16_t getAvailableEnergy()     { return readFieldOrZero(Field::AVAILABLE_ENERGY); }  // 10 mWh units
+    int16_t getAvailablePower()       { return static_cast<int16_t>(readFieldOrZero(Field::AVERAGE_POWER)); }  // 10 mW units, negative while discharging
+    uint16_t getSerialNumber()        { return readFieldOrZero(Field::SERIAL_NUMBER); }
+    uint16_t getInternalTemperature() { return readFieldOrZero(Field::INTERNAL_TEMPERATURE); }  // Returns 0.1K
+    uint16_t getChargeVoltage()       { return readFieldOrZero(Field::CHARGE_VOLTAGE); }  // Returns millivolts
+    uint16_t getChargeCurrent()       { return readFieldOrZero(Field::CHARGE_CURRENT); }  // Returns milliamps
+
+    // Read one field as its register descriptor defines it: width, percent clamp and
+    // plausibility range. Fails with Status::OUT_OF_RANGE when the value is implausible
+    bool readField(Field field, uint16_t& value);
+    bool decodeField(Field field, const uint8_t* data, uint16_t& value);
+    static uint8_t fieldRegister(Field field);
 
     // Helper functions for unit conversion
+#ifndef BMSLIB_NO_FLOAT
     float readVoltage_inVolts();
     float readCurrent_inAmps();
     float readCapacity_inAmpHours();
     float readTemperature_inCelsius();
     float readFullChargeCapacity_inAmpHours();
     float readRemainingCapacity_inAmpHours();
+    float getAvailableEnergy_inWh();
+    float getAvailablePower_inW();
+    float getChargeVoltage_inVolts();
+    float getChargeCurrent_inAmps();
+#endif
+
+    // Integer unit conversion; no floating point, suited to FPU-less targets
+    uint16_t readVoltage_inMillivolts();         // Temperature compensated
+    int32_t readTemperature_inMilliCelsius();
     
 	// Battery Capacity functions
     bool setDesignCapacity(uint16_t capacity_mAh);  // Set design capacity in mAh
@@ -228,6 +551,73 @@ public:
     bool getLifetimeStats(LifetimeStats& stats);
     bool resetLifetimeStats();
     bool getDetailedStatus(DetailedStatus& status);
+    bool readStatusSnapshot(StatusSnapshot& snapshot);
+    // Decode only; readers that complete a snapshot then call notifySnapshotListeners()
+    void decodeStatusSnapshot(const uint8_t* buffer, StatusSnapshot& snapshot);  // BMS_SNAPSHOT_LENGTH bytes
+
+    // Listeners see every snapshot, whoever requested it (bus manager, telemetry, ...)
+    typedef void (*SnapshotListener)(const StatusSnapshot& snapshot, void* context);
+    bool addSnapshotListener(SnapshotListener listener, void* context = nullptr);
+    void removeSnapshotListener(SnapshotListener listener, void* context = nullptr);
+    void notifySnapshotListeners(const StatusSnapshot& snapshot);
+
+    // Read plans (coalesced burst reads of arbitrary field sets)
+    static bool compileReadPlan(uint32_t fields, ReadPlan& plan,
+                                uint8_t maxGap = BMS_READ_PLAN_MAX_GAP);
+    bool executeReadPlan(const ReadPlan& plan, FieldValues& values);
+    bool readFields(uint32_t fields, FieldValues& values);
+
+    // Bus statistics
+    const BusStats& getBusStats() const;
+    void resetBusStats();
+
+    // Transport: every bus call records a Status; value getters that return 0 on
+    // failure can be told apart from a real zero with getLastStatus()
+    void setTransportConfig(const TransportConfig& config);
+    const TransportConfig& getTransportConfig() const;
+    Status getLastStatus() const;
+    Status readRegister(uint8_t command, uint16_t& value);
+    Status writeRegister(uint8_t command, uint16_t value);
+    Status readRegisters(uint8_t command, uint8_t* data, uint8_t length);
+    bool recoverBus();
+
+    // Split-phase read, driven by BMSTransferQueue. With a BMS_BUS_ASYNC backend the
+    // transfer runs on the bus engine between the calls; otherwise startRead() does the
+    // whole transfer. pollRead() returns true once the read is over, with its outcome
+    Status startRead(uint8_t command, uint8_t* data, uint8_t length);
+    bool pollRead(Status& status);
+    bool isReadPending() const;
+
+    // Read cache (disabled by default)
+    void enableCache(bool enable = true);
+    bool setCacheTtl(uint8_t command, uint16_t ttlMs);
+    void invalidateCache();
+    const CacheStats& getCacheStats() const;
+    void resetCacheStats();
+
+    // Data flash block access (requires config mode)
+    bool readDataFlashBlock(uint8_t subclass, uint8_t block, uint8_t* data);
+    bool writeDataFlashBlock(uint8_t subclass, uint8_t block, const uint8_t* data);
+
+    // Data flash shadow image: blocks are loaded once and served from RAM; writes
+    // mark dirty byte ranges that flushShadow() commits. Offsets span blocks.
+    bool readShadow(uint8_t subclass, uint8_t offset, uint8_t* data, uint8_t length);
+    bool writeShadow(uint8_t subclass, uint8_t offset, const uint8_t* data, uint8_t length);
+    bool flushShadow();
+    void invalidateShadow();
+    bool isShadowDirty() const;
+
+    // Golden image: write only the blocks that differ (changed range plus checksum),
+    // each verified by reading the checksum back; compareImage() writes nothing and
+    // returns true when the unit already matches
+    bool applyImage(const uint8_t* image, uint16_t length, ImageResult& result);
+    bool compareImage(const uint8_t* image, uint16_t length, ImageResult& result);
+
+    // Fingerprints: the image's own values, or the unit's current values at the same
+    // places; compareFingerprints() returns one bit per differing record
+    static bool imageFingerprint(const uint8_t* image, uint16_t length, Fingerprint& fingerprint);
+    bool readFingerprint(const uint8_t* image, uint16_t length, Fingerprint& fingerprint);
+    static uint32_t compareFingerprints(const Fingerprint& a, const Fingerprint& b);
 
     // Chemistry Management Functions
     bool setBatteryChemistry(BatteryChemistry chemistry);
@@ -237,7 +627,10 @@ public:
     // Self-Discharge Management Functions
     bool configureSelfDischarge(const SelfDischargeConfig& config);
     bool getSelfDischargeConfig(SelfDischargeConfig& config);
+#ifndef BMSLIB_NO_FLOAT
     float getEstimatedSelfDischarge();  // Returns estimated self-discharge in percent
+#endif
+    int32_t getEstimatedSelfDischarge_inMilliPercent();  // Per day, 0.001% units
 
     // Extended Power Management Functions
     bool setPowerMode(PowerMode mode);
@@ -265,28 +658,202 @@ public:
     // Factory reset
     bool factoryReset();
 
+    // Non-blocking variants; one operation runs at a time, advanced by poll()
+    OpHandle beginAsync();
+    OpHandle enterConfigModeAsync();
+    OpHandle exitConfigModeAsync();
+    OpHandle wakeAsync();
+    OpHandle setPowerModeAsync(PowerMode mode);
+    OpHandle setBatteryChemistryAsync(BatteryChemistry chemistry);
+    OpHandle factoryResetAsync();
+    OpState poll();
+    OpState getOpState(OpHandle handle) const;
+    bool isBusy() const;
+
 private:
     // Constants
     static constexpr uint16_t MIN_VOLTAGE = 2000;      // 2.0V minimum valid voltage
     static constexpr uint16_t MAX_VOLTAGE = 4500;      // 4.5V maximum valid voltage
     static constexpr int16_t MAX_CURRENT = 5000;       // 5.0A maximum current
     static constexpr uint16_t MAX_TEMPERATURE = 3430;  // 70°C maximum temperature
-    static constexpr float TEMP_COEFFICIENT = 0.0001f;  // Temperature coefficient for voltage compensation
+    static constexpr int32_t TEMP_COEFFICIENT_PPM = 100;  // Voltage compensation per °C, parts per million
+    static constexpr int32_t TEMP_REFERENCE_CK = 29815;   // Compensation reference, 25°C in 0.01K
+#ifndef BMSLIB_NO_FLOAT
+    static constexpr float TEMP_COEFFICIENT = TEMP_COEFFICIENT_PPM / 1000000.0f;
+#endif
+    static constexpr uint16_t STARTUP_SETTLE_MS = 100;  // Longest wait for the gauge to answer after begin
+    static constexpr uint16_t CONFIG_SETTLE_MS = 100;   // Config mode enter/exit
+    static constexpr uint16_t MODE_SETTLE_MS = 100;     // Wake, power mode and chemistry changes
+    static constexpr uint16_t RESET_SETTLE_MS = 500;    // Factory reset and shutdown
+
+    // Non-blocking operation steps
+    enum class StepKind : uint8_t {
+        WIRE_BEGIN,     // Start the I2C peripheral
+        WRITE,          // writeWord(command, value)
+        WAIT,           // Settle for value ms
+        WAIT_READY,     // Until the gauge answers, at most value ms
+        CHECK_ONLINE,   // Gauge must answer
+        ENTER_CONFIG,   // Raw enterConfigMode()
+        EXIT_CONFIG,    // Raw exitConfigMode()
+        CONFIG_BEGIN,   // Non-blocking beginConfig()
+        CONFIG_END      // Non-blocking endConfig()
+    };
+
+    static constexpr uint8_t STEP_CLEANUP = 0x01;   // Runs even after a failed step
+    static constexpr uint8_t STEP_OPTIONAL = 0x02;  // Failure does not fail the operation
+
+    struct OpStep {
+        StepKind kind;
+        uint8_t flags;
+        uint8_t command;
+        uint16_t value;
+    };
+
+    static constexpr uint8_t CACHE_USED = 0x01;    // Slot holds a register
+    static constexpr uint8_t CACHE_VALID = 0x02;   // Value is loaded
+    static constexpr uint8_t CACHE_PINNED = 0x04;  // TTL set explicitly; never evicted
+
+    struct ShadowBlock {
+        uint8_t subclass;
+        uint8_t block;
+        bool loaded;
+        uint8_t lastUse;           // LRU clock value
+        uint8_t dirtyFrom;         // First modified byte
+        uint8_t dirtyTo;           // One past the last modified byte; 0 when clean
+        uint8_t data[BMS_DATAFLASH_BLOCK_SIZE];
+    };
+
+    struct ListenerSlot {
+        SnapshotListener listener;
+        void* context;
+    };
+
+    struct CacheEntry {
+        uint8_t command;
+        uint8_t flags;
+        uint16_t value;
+        uint16_t ttlMs;
+        uint32_t stamp;            // millis() when the value was read
+    };
 
     // Member variables
-    TwoWire *_wire;
+    BMSBus *_wire;
+    uint8_t _address;
+    TransportConfig _transport;
+    Status _lastStatus;
+    Status _splitStatus;
+    bool _splitPending;
+#ifdef BMS_BUS_ASYNC
+    bool _splitRunning;
+    uint8_t _splitCommand;
+    uint8_t _splitLength;
+    uint8_t _splitAttempt;
+    uint8_t* _splitData;
+#endif
     bool _configMode;
+    BusStats _busStats;
+    uint8_t _dfClass;
+    uint8_t _dfBlock;
+    uint8_t _configDepth;
+    bool _configScoped;
+    ConfigSession* _session;
+    OpStep _opSteps[BMS_ASYNC_MAX_STEPS];
+    uint8_t _opCount;
+    uint8_t _opIndex;
+    OpHandle _opHandle;
+    OpState _opState;
+    bool _opFailed;
+    bool _opWaiting;
+    bool _opStepLive;
+    bool _opScopeHeld;
+    uint32_t _opWaitStart;
+    uint16_t _opWaitMs;
+    bool _cacheEnabled;
+    CacheStats _cacheStats;
+#if BMS_READ_CACHE_ENTRIES > 0
+    CacheEntry _cache[BMS_READ_CACHE_ENTRIES];
+#endif
+#if BMS_SNAPSHOT_LISTENERS > 0
+    ListenerSlot _listeners[BMS_SNAPSHOT_LISTENERS];
+#endif
+    uint8_t _shadowClock;
+#if BMS_SHADOW_BLOCKS > 0
+    ShadowBlock _shadow[BMS_SHADOW_BLOCKS];
+#endif
+
+    // Register descriptor table (see FIELD_INFO)
+    uint16_t readFieldOrZero(Field field);
 
     // I2C operations
     bool readWord(uint8_t command, uint16_t &value);
     bool writeWord(uint8_t command, uint16_t data);
+    bool readBlock(uint8_t command, uint8_t* data, uint8_t length);
+    bool writeBlock(uint8_t command, const uint8_t* data, uint8_t length);
+
+    // Transport attempts, retry policy and Wire timeout setup
+    Status transferRead(uint8_t command, uint8_t* data, uint8_t length);
+    Status transferWrite(uint8_t command, const uint8_t* data, uint8_t length);
+    Status readOnce(uint8_t command, uint8_t* data, uint8_t length);
+    Status writeOnce(uint8_t command, const uint8_t* data, uint8_t length);
+    bool shouldRetry(Status& status, uint8_t attempt, bool idempotent);
+    Status finishTransfer(Status status);
+    Status wireStatus(uint8_t code);
+    bool wireTimedOut();
+    void applyWireTimeout();
+    void applyWireClock();
     
+    // Nestable config mode scope used by every setter
+    bool beginConfig();
+    bool endConfig(bool success);
+
+    // Read cache
+    static uint16_t defaultCacheTtl(uint8_t command);
+    CacheEntry* cacheSlot(uint8_t command, bool allocate);
+    static uint8_t cacheRank(const CacheEntry& entry);    // Eviction order: free, invalid, valid
+    bool cacheLookup(uint8_t command, uint16_t& value);
+    void cacheStore(uint8_t command, uint16_t value);
+    void cacheStoreBlock(uint8_t command, const uint8_t* data, uint8_t length);
+    void cacheInvalidate(uint8_t command, uint8_t length);
+
+    // Data flash shadow image
+    ShadowBlock* shadowFind(uint8_t subclass, uint8_t block);
+    ShadowBlock* shadowLoad(uint8_t subclass, uint8_t block);
+    bool shadowFlushBlock(ShadowBlock& slot);
+    void shadowUpdate(uint8_t subclass, uint8_t block, const uint8_t* data);
+    bool readDataFlashDirect(uint8_t subclass, uint8_t offset, uint8_t* data, uint8_t length);
+    bool writeDataFlashDirect(uint8_t subclass, uint8_t offset, const uint8_t* data, uint8_t length);
+
+    // Non-blocking operation engine
+    OpHandle startOp();
+    void addStep(StepKind kind, uint8_t command = 0, uint16_t value = 0, uint8_t flags = 0);
+    bool runStep(const OpStep& step, uint16_t& settleMs);
+    void finishStep(const OpStep& step);
+    bool probeReady();
+    bool waitOp(OpHandle handle);
+
     // Data flash operations
+    bool selectDataFlashBlock(uint8_t subclass, uint8_t block);
     bool readDataFlash(uint8_t offset, uint8_t* data, uint8_t length);
     bool writeDataFlash(uint8_t offset, const uint8_t* data, uint8_t length);
+    bool commitDataFlash(const uint8_t* block, uint8_t from, uint8_t to);
+    static uint8_t dataFlashChecksum(const uint8_t* block);
+
+    // Golden image
+    bool processImage(const uint8_t* image, uint16_t length, bool write, ImageResult& result);
+    bool imageBlock(const uint8_t* image, uint16_t length, uint8_t subclass, uint8_t block,
+                    bool write, ImageResult& result);
+    bool imageRegister(const uint8_t* record, bool write, ImageResult& result);
+    static bool imageValid(const uint8_t* image, uint16_t length);
+    static uint32_t fingerprintHash(uint32_t hash, const uint8_t* data, uint16_t length);
+    static void fingerprintSection(Fingerprint& fingerprint, uint16_t record, uint32_t hash);
     
     // Helper functions
+#ifndef BMSLIB_NO_FLOAT
     float compensateTemperature(float voltage, float temperature);
+#endif
+    uint16_t compensateTemperature_mV(uint16_t millivolts, uint16_t temperature);
+    static int32_t temperatureOffset_cC(uint16_t temperature);
+    static uint16_t calibrationGain(int32_t actual, int32_t measured);
     bool validateTemperature(uint16_t temp);
     bool validateVoltage(uint16_t voltage);
     bool validateCurrent(int16_t current);
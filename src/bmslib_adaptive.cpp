@@ -0,0 +1,253 @@
+#include "bmslib_adaptive.h"
+
+namespace {
+
+typedef BMSLib::Field Field;
+
+const uint32_t QUANTITY_FIELDS[] = {
+    BMSLib::fieldMask(Field::CURRENT) | BMSLib::fieldMask(Field::AVERAGE_CURRENT) |
+        BMSLib::fieldMask(Field::FLAGS),
+    BMSLib::fieldMask(Field::VOLTAGE),
+    BMSLib::fieldMask(Field::TEMPERATURE),
+    BMSLib::fieldMask(Field::STATE_OF_CHARGE) | BMSLib::fieldMask(Field::REMAINING_CAPACITY) |
+        BMSLib::fieldMask(Field::FULL_CAPACITY),
+    BMSLib::fieldMask(Field::STATE_OF_HEALTH) | BMSLib::fieldMask(Field::CYCLE_COUNT),
+};
+
+// Field whose step size drives the change boost
+const Field CHANGE_FIELD[] = {
+    Field::CURRENT, Field::VOLTAGE, Field::TEMPERATURE, Field::STATE_OF_CHARGE, Field::STATE_OF_HEALTH
+};
+
+static_assert(sizeof(QUANTITY_FIELDS) / sizeof(QUANTITY_FIELDS[0]) == BMSAdaptivePoller::QUANTITY_COUNT,
+              "QUANTITY_FIELDS must cover every quantity");
+static_assert(sizeof(CHANGE_FIELD) / sizeof(CHANGE_FIELD[0]) == BMSAdaptivePoller::QUANTITY_COUNT,
+              "CHANGE_FIELD must cover every quantity");
+
+const uint16_t FLAG_CHARGING = 0x0001;      // As decoded by getDetailedStatus()
+const uint16_t FLAG_DISCHARGING = 0x0002;
+
+}  // namespace
+
+BMSAdaptivePoller::BMSAdaptivePoller(BMSLib& gauge) :
+    _gauge(gauge),
+    _activeCurrent(BMS_ADAPTIVE_ACTIVE_CURRENT),
+    _active(false),
+    _budget(0),
+    _tokens(0),
+    _lastRefill(0),
+    _windowStart(millis()) {
+    memset(&_values, 0, sizeof(_values));
+    memset(_schedules, 0, sizeof(_schedules));
+    resetStats();
+
+    setRates(CURRENT, 20, 5000);        // 50 Hz under load, 0.2 Hz at rest
+    setRates(VOLTAGE, 100, 5000);
+    setRates(TEMPERATURE, 1000, 1000);
+    setRates(CHARGE, 1000, 10000);
+    setRates(HEALTH, 60000, 60000);
+    setChangeThreshold(CURRENT, 50);    // mA
+    setChangeThreshold(VOLTAGE, 20);    // mV
+    setChangeThreshold(TEMPERATURE, 5); // 0.5K
+    setChangeThreshold(CHARGE, 1);      // %
+}
+
+void BMSAdaptivePoller::setRates(Quantity quantity, uint32_t activeIntervalMs, uint32_t idleIntervalMs) {
+    if (quantity < QUANTITY_COUNT) {
+        _schedules[quantity].activeMs = activeIntervalMs;
+        _schedules[quantity].idleMs = idleIntervalMs;
+    }
+}
+
+void BMSAdaptivePoller::setChangeThreshold(Quantity quantity, uint16_t delta) {
+    if (quantity < QUANTITY_COUNT) {
+        _schedules[quantity].changeDelta = delta;
+    }
+}
+
+void BMSAdaptivePoller::setActiveCurrent(uint16_t milliamps) {
+    _activeCurrent = milliamps;
+}
+
+void BMSAdaptivePoller::setBusBudget(uint32_t bytesPerSecond) {
+    _budget = bytesPerSecond;
+    _tokens = 0;
+    _lastRefill = millis();
+}
+
+bool BMSAdaptivePoller::poll() {
+    uint32_t now = millis();
+    updateRates(now);
+
+    uint32_t fields = 0;
+    for (uint8_t q = 0; q < QUANTITY_COUNT; q++) {
+        if (isDue(q, now)) {
+            fields |= QUANTITY_FIELDS[q];
+        }
+    }
+    if (fields == 0) {
+        return false;
+    }
+
+    // Token bucket: a read may overdraw, the next one waits until it is paid back
+    if (_budget > 0) {
+        refill(now);
+        if (_tokens <= 0) {
+            _stats.deferred++;
+            return false;
+        }
+    }
+
+    BMSLib::ReadPlan plan;
+    BMSLib::FieldValues fresh;
+    BMSLib::BusStats before = _gauge.getBusStats();
+    bool success = BMSLib::compileReadPlan(fields, plan) && _gauge.executeReadPlan(plan, fresh);
+    BMSLib::BusStats after = _gauge.getBusStats();
+
+    uint32_t bytes = after.bytes - before.bytes;
+    _stats.transactions += after.transactions - before.transactions;
+    _stats.bytes += bytes;
+    _tokens -= bytes;
+
+    if (!success) {
+        _stats.failures++;
+        return false;
+    }
+    _stats.reads++;
+
+    for (uint8_t q = 0; q < QUANTITY_COUNT; q++) {
+        if ((fields & QUANTITY_FIELDS[q]) != 0) {
+            record(q, fresh, now);
+        }
+    }
+
+    // Load or the gauge's charge/discharge flags put every quantity on its fast rate
+    if (fresh.has(Field::CURRENT)) {
+        int16_t current = fresh.getSigned(Field::CURRENT);
+        uint16_t magnitude = current < 0 ? -current : current;
+        uint16_t flags = fresh.get(Field::FLAGS);
+        _active = magnitude >= _activeCurrent || (flags & (FLAG_CHARGING | FLAG_DISCHARGING)) != 0;
+    }
+    return true;
+}
+
+bool BMSAdaptivePoller::isActive() const {
+    return _active;
+}
+
+const BMSLib::FieldValues& BMSAdaptivePoller::getValues() const {
+    return _values;
+}
+
+uint32_t BMSAdaptivePoller::getSampleAge(Quantity quantity) const {
+    if (quantity >= QUANTITY_COUNT || !_schedules[quantity].sampled) {
+        return UINT32_MAX;
+    }
+    return millis() - _schedules[quantity].lastSample;
+}
+
+uint32_t BMSAdaptivePoller::getInterval(Quantity quantity) const {
+    if (quantity >= QUANTITY_COUNT) {
+        return 0;
+    }
+    const Schedule& schedule = _schedules[quantity];
+    return _active || isBoosted(quantity, millis()) ? schedule.activeMs : schedule.idleMs;
+}
+
+uint32_t BMSAdaptivePoller::getAchievedRate_mHz(Quantity quantity) const {
+    return quantity < QUANTITY_COUNT ? _schedules[quantity].rate_mHz : 0;
+}
+
+uint32_t BMSAdaptivePoller::getTimeUntilDueMs() const {
+    uint32_t now = millis();
+    uint32_t wait = UINT32_MAX;
+    for (uint8_t q = 0; q < QUANTITY_COUNT; q++) {
+        const Schedule& schedule = _schedules[q];
+        if (!schedule.sampled) {
+            return 0;
+        }
+        uint32_t interval = getInterval(static_cast<Quantity>(q));
+        uint32_t elapsed = now - schedule.lastSample;
+        uint32_t remaining = elapsed >= interval ? 0 : interval - elapsed;
+        if (remaining < wait) {
+            wait = remaining;
+        }
+    }
+    return wait;
+}
+
+const BMSAdaptivePoller::Stats& BMSAdaptivePoller::getStats() const {
+    return _stats;
+}
+
+void BMSAdaptivePoller::resetStats() {
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+bool BMSAdaptivePoller::isDue(uint8_t quantity, uint32_t now) const {
+    const Schedule& schedule = _schedules[quantity];
+    if (!schedule.sampled) {
+        return true;
+    }
+    uint32_t interval = _active || isBoosted(quantity, now) ? schedule.activeMs : schedule.idleMs;
+    return now - schedule.lastSample >= interval;
+}
+
+bool BMSAdaptivePoller::isBoosted(uint8_t quantity, uint32_t now) const {
+    return (int32_t)(_schedules[quantity].boostUntil - now) > 0;
+}
+
+void BMSAdaptivePoller::refill(uint32_t now) {
+    uint32_t elapsed = now - _lastRefill;
+    uint32_t earned = _budget * elapsed / 1000;
+    if (earned == 0) {
+        return;  // Keep the remainder accumulating in elapsed
+    }
+    _lastRefill = now;
+
+    // Allow bursts of up to a tenth of a second's budget
+    int32_t cap = _budget / 10 > 32 ? _budget / 10 : 32;
+    _tokens = _tokens + (int32_t)earned > cap ? cap : _tokens + (int32_t)earned;
+}
+
+void BMSAdaptivePoller::record(uint8_t quantity, const BMSLib::FieldValues& fresh, uint32_t now) {
+    Schedule& schedule = _schedules[quantity];
+    uint8_t index = static_cast<uint8_t>(CHANGE_FIELD[quantity]);
+
+    if (schedule.sampled && schedule.changeDelta > 0 && fresh.has(CHANGE_FIELD[quantity])) {
+        int32_t previous = _values.values[index];
+        int32_t current = fresh.values[index];
+        if (CHANGE_FIELD[quantity] == Field::CURRENT) {
+            previous = (int16_t)previous;
+            current = (int16_t)current;
+        }
+        int32_t step = current > previous ? current - previous : previous - current;
+        if (step >= schedule.changeDelta) {
+            schedule.boostUntil = now + BMS_ADAPTIVE_BOOST_MS;
+        }
+    }
+
+    for (uint8_t field = 0; field < static_cast<uint8_t>(Field::COUNT); field++) {
+        if ((QUANTITY_FIELDS[quantity] & fresh.valid & (1UL << field)) != 0) {
+            _values.values[field] = fresh.values[field];
+            _values.valid |= 1UL << field;
+        }
+    }
+
+    schedule.sampled = true;
+    schedule.lastSample = now;
+    schedule.windowCount++;
+}
+
+void BMSAdaptivePoller::updateRates(uint32_t now) {
+    uint32_t elapsed = now - _windowStart;
+    if (elapsed < BMS_ADAPTIVE_RATE_WINDOW) {
+        return;
+    }
+    for (uint8_t q = 0; q < QUANTITY_COUNT; q++) {
+        // 64-bit: a count above ~4300 would overflow the scaled 32-bit product
+        _schedules[q].rate_mHz = (uint32_t)((uint64_t)_schedules[q].windowCount * 1000000UL / elapsed);
+        _schedules[q].windowCount = 0;
+    }
+    _windowStart = now;
+}
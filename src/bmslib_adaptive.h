@@ -0,0 +1,83 @@
+#ifndef BMSLIB_ADAPTIVE_H
+#define BMSLIB_ADAPTIVE_H
+
+#include "BMSLib.h"
+
+#define BMS_ADAPTIVE_ACTIVE_CURRENT 100     // |mA| above which the pack counts as active
+#define BMS_ADAPTIVE_BOOST_MS       2000    // Fast rate held after a sudden change
+#define BMS_ADAPTIVE_RATE_WINDOW    10000   // Window for achieved-rate measurement (ms)
+
+// Polls each quantity at its own rate, faster while the pack is under load or a value
+// is moving and slower at rest. Quantities that fall due together are fetched with
+// one coalesced read plan, and an optional bus budget caps the bytes per second.
+class BMSAdaptivePoller {
+public:
+    enum Quantity : uint8_t {
+        CURRENT,        // CURRENT, AVERAGE_CURRENT, FLAGS; also decides the activity state
+        VOLTAGE,        // VOLTAGE
+        TEMPERATURE,    // TEMPERATURE
+        CHARGE,         // STATE_OF_CHARGE, REMAINING_CAPACITY, FULL_CAPACITY
+        HEALTH,         // STATE_OF_HEALTH, CYCLE_COUNT
+        QUANTITY_COUNT
+    };
+
+    struct Stats {
+        uint32_t reads;         // Plan executions
+        uint32_t deferred;      // Polls held back by the bus budget
+        uint32_t failures;
+        uint32_t transactions;
+        uint32_t bytes;
+    };
+
+    explicit BMSAdaptivePoller(BMSLib& gauge);
+
+    // Intervals used while active (load or a recent change) and at rest
+    void setRates(Quantity quantity, uint32_t activeIntervalMs, uint32_t idleIntervalMs);
+    // A step larger than delta between two samples holds the fast rate for a while; 0 disables
+    void setChangeThreshold(Quantity quantity, uint16_t delta);
+    void setActiveCurrent(uint16_t milliamps);
+    void setBusBudget(uint32_t bytesPerSecond);   // 0 = unlimited
+
+    // Read whatever is due; true when a read was made
+    bool poll();
+
+    bool isActive() const;
+    const BMSLib::FieldValues& getValues() const;  // Latest raw values of all quantities
+    uint32_t getSampleAge(Quantity quantity) const;
+    uint32_t getInterval(Quantity quantity) const;  // Interval currently in force
+    uint32_t getAchievedRate_mHz(Quantity quantity) const;
+    uint32_t getTimeUntilDueMs() const;
+    const Stats& getStats() const;
+    void resetStats();
+
+private:
+    struct Schedule {
+        uint32_t activeMs;
+        uint32_t idleMs;
+        uint16_t changeDelta;
+        bool sampled;
+        uint32_t lastSample;
+        uint32_t boostUntil;
+        uint16_t windowCount;
+        uint32_t rate_mHz;
+    };
+
+    BMSLib& _gauge;
+    BMSLib::FieldValues _values;
+    Schedule _schedules[QUANTITY_COUNT];
+    uint16_t _activeCurrent;
+    bool _active;
+    uint32_t _budget;
+    int32_t _tokens;
+    uint32_t _lastRefill;
+    uint32_t _windowStart;
+    Stats _stats;
+
+    bool isDue(uint8_t quantity, uint32_t now) const;
+    bool isBoosted(uint8_t quantity, uint32_t now) const;
+    void refill(uint32_t now);
+    void record(uint8_t quantity, const BMSLib::FieldValues& fresh, uint32_t now);
+    void updateRates(uint32_t now);
+};
+
+#endif // BMSLIB_ADAPTIVE_H
@@ -0,0 +1,186 @@
+#include "bmslib_alarm.h"
+
+namespace {
+
+// FLAGS safety bits, as tested by isOverVoltage() and friends
+const uint16_t GAUGE_FLAG[] = { 0x0001, 0x0002, 0x0004, 0x0008, 0x0000, 0x0000 };
+
+static_assert(sizeof(GAUGE_FLAG) / sizeof(GAUGE_FLAG[0]) == BMSAlarmEngine::CONDITION_COUNT,
+              "GAUGE_FLAG must cover every condition");
+
+}  // namespace
+
+BMSAlarmEngine::BMSAlarmEngine(BMSLib& gauge) :
+    _gauge(gauge),
+    _anyHandler(nullptr),
+    _anyContext(nullptr),
+    _gaugeFlags(false),
+    _intervalMs(0),
+    _lastTick(0),
+    _ticks(0) {
+    memset(_states, 0, sizeof(_states));
+
+    // SOC through FLAGS spans 0x02-0x0F; allow the gap so it stays a single burst
+    BMSLib::compileReadPlan(BMSLib::fieldMask(BMSLib::Field::STATE_OF_CHARGE) |
+                            BMSLib::fieldMask(BMSLib::Field::VOLTAGE) |
+                            BMSLib::fieldMask(BMSLib::Field::TEMPERATURE) |
+                            BMSLib::fieldMask(BMSLib::Field::FLAGS) |
+                            BMSLib::fieldMask(BMSLib::Field::CURRENT),
+                            _plan, 8);
+}
+
+bool BMSAlarmEngine::setThreshold(Condition condition, int32_t trip, int32_t clear, uint8_t debounce) {
+    if (condition >= CONDITION_COUNT) {
+        return false;
+    }
+
+    // The clear level must sit on the safe side of the trip level
+    if (isHighCondition(condition) ? clear > trip : clear < trip) {
+        return false;
+    }
+
+    State& state = _states[condition];
+    state.trip = trip;
+    state.clear = clear;
+    state.debounce = debounce > 0 ? debounce : 1;
+    state.pending = 0;
+    state.enabled = true;
+    return true;
+}
+
+void BMSAlarmEngine::disable(Condition condition) {
+    if (condition < CONDITION_COUNT) {
+        _states[condition].enabled = false;
+        _states[condition].pending = 0;
+    }
+}
+
+void BMSAlarmEngine::useGaugeFlags(bool enable) {
+    _gaugeFlags = enable;
+}
+
+void BMSAlarmEngine::onAlarm(Condition condition, Handler handler, void* context) {
+    if (condition < CONDITION_COUNT) {
+        _states[condition].handler = handler;
+        _states[condition].context = context;
+    }
+}
+
+void BMSAlarmEngine::onAnyAlarm(Handler handler, void* context) {
+    _anyHandler = handler;
+    _anyContext = context;
+}
+
+void BMSAlarmEngine::setInterval(uint16_t intervalMs) {
+    _intervalMs = intervalMs;
+}
+
+bool BMSAlarmEngine::tick() {
+    uint32_t now = millis();
+    if (_ticks > 0 && now - _lastTick < _intervalMs) {
+        return true;
+    }
+    _lastTick = now;
+
+    BMSLib::FieldValues fields;
+    if (!_gauge.executeReadPlan(_plan, fields)) {
+        return false;
+    }
+
+    int16_t current = fields.getSigned(BMSLib::Field::CURRENT);
+    int32_t values[CONDITION_COUNT];
+    values[OVER_VOLTAGE] = fields.get(BMSLib::Field::VOLTAGE);
+    values[UNDER_VOLTAGE] = values[OVER_VOLTAGE];
+    values[OVER_CURRENT] = current < 0 ? -(int32_t)current : current;
+    values[OVER_TEMPERATURE] = fields.get(BMSLib::Field::TEMPERATURE);
+    values[UNDER_TEMPERATURE] = values[OVER_TEMPERATURE];
+    values[LOW_SOC] = fields.get(BMSLib::Field::STATE_OF_CHARGE) & 0xFF;
+
+    evaluate(values, fields.get(BMSLib::Field::FLAGS));
+    return true;
+}
+
+void BMSAlarmEngine::evaluate(const BMSLib::StatusSnapshot& snapshot) {
+    // The range-checked fields read 0 for exactly the readings that should raise an
+    // alarm, so evaluate the raw register words like tick() does
+    int32_t values[CONDITION_COUNT];
+    values[OVER_VOLTAGE] = snapshot.rawVoltage;
+    values[UNDER_VOLTAGE] = snapshot.rawVoltage;
+    values[OVER_CURRENT] = snapshot.rawCurrent < 0 ? -(int32_t)snapshot.rawCurrent : snapshot.rawCurrent;
+    values[OVER_TEMPERATURE] = snapshot.rawTemperature;
+    values[UNDER_TEMPERATURE] = snapshot.rawTemperature;
+    values[LOW_SOC] = snapshot.stateOfCharge;
+
+    evaluate(values, snapshot.flags);
+}
+
+bool BMSAlarmEngine::isActive(Condition condition) const {
+    return condition < CONDITION_COUNT && _states[condition].active;
+}
+
+uint8_t BMSAlarmEngine::getActiveMask() const {
+    uint8_t mask = 0;
+    for (uint8_t i = 0; i < CONDITION_COUNT; i++) {
+        if (_states[i].active) {
+            mask |= 1 << i;
+        }
+    }
+    return mask;
+}
+
+uint32_t BMSAlarmEngine::getTickCount() const {
+    return _ticks;
+}
+
+void BMSAlarmEngine::evaluate(const int32_t* values, uint16_t flags) {
+    _ticks++;
+    for (uint8_t i = 0; i < CONDITION_COUNT; i++) {
+        Condition condition = static_cast<Condition>(i);
+        bool flagged = _gaugeFlags && (flags & GAUGE_FLAG[i]) != 0;
+        update(condition, values[i], flagged);
+    }
+}
+
+void BMSAlarmEngine::update(Condition condition, int32_t value, bool flagged) {
+    State& state = _states[condition];
+    if (!state.enabled && !flagged && !state.active) {
+        return;
+    }
+
+    bool high = isHighCondition(condition);
+    bool tripped = flagged ||
+                   (state.enabled && (high ? value >= state.trip : value <= state.trip));
+    bool released = !flagged &&
+                    (!state.enabled || (high ? value <= state.clear : value >= state.clear));
+
+    // Inside the hysteresis band the alarm keeps its state
+    bool toggle = state.active ? released : tripped;
+    if (!toggle) {
+        state.pending = 0;
+        return;
+    }
+
+    // Gauge flags are already debounced by the gauge
+    uint8_t required = flagged ? 1 : (state.debounce > 0 ? state.debounce : 1);
+    if (++state.pending < required) {
+        return;
+    }
+
+    state.pending = 0;
+    state.active = !state.active;
+    notify(condition, state.active ? Event::RAISED : Event::CLEARED, value);
+}
+
+void BMSAlarmEngine::notify(Condition condition, Event event, int32_t value) {
+    const State& state = _states[condition];
+    if (state.handler != nullptr) {
+        state.handler(condition, event, value, state.context);
+    }
+    if (_anyHandler != nullptr) {
+        _anyHandler(condition, event, value, _anyContext);
+    }
+}
+
+bool BMSAlarmEngine::isHighCondition(Condition condition) {
+    return condition == OVER_VOLTAGE || condition == OVER_CURRENT || condition == OVER_TEMPERATURE;
+}
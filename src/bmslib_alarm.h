@@ -0,0 +1,82 @@
+#ifndef BMSLIB_ALARM_H
+#define BMSLIB_ALARM_H
+
+#include "BMSLib.h"
+
+// Edge-triggered alarms. Each tick reads voltage, current, temperature, SoC and FLAGS
+// in one burst, applies thresholds with hysteresis and debounce, and calls handlers
+// only when a condition is raised or cleared.
+class BMSAlarmEngine {
+public:
+    enum Condition : uint8_t {
+        OVER_VOLTAGE,       // mV, raised at or above the trip level
+        UNDER_VOLTAGE,      // mV, raised at or below
+        OVER_CURRENT,       // |mA| in either direction, raised at or above
+        OVER_TEMPERATURE,   // 0.1K, raised at or above
+        UNDER_TEMPERATURE,  // 0.1K, raised at or below
+        LOW_SOC,            // %, raised at or below
+        CONDITION_COUNT
+    };
+
+    enum class Event : uint8_t {
+        RAISED,
+        CLEARED
+    };
+
+    typedef void (*Handler)(Condition condition, Event event, int32_t value, void* context);
+
+    explicit BMSAlarmEngine(BMSLib& gauge);
+
+    // trip raises the alarm, clear (on the safe side of trip) releases it; debounce is
+    // the number of consecutive ticks a transition must hold before it is reported
+    bool setThreshold(Condition condition, int32_t trip, int32_t clear, uint8_t debounce = 1);
+    void disable(Condition condition);
+
+    // Also raise OV/UV/OC/OT from the gauge's own FLAGS safety bits
+    void useGaugeFlags(bool enable = true);
+
+    void onAlarm(Condition condition, Handler handler, void* context = nullptr);
+    void onAnyAlarm(Handler handler, void* context = nullptr);
+
+    void setInterval(uint16_t intervalMs);  // Minimum time between reads, default 0
+
+    // Read and evaluate if due; false when the read failed
+    bool tick();
+
+    // Evaluate values read elsewhere, e.g. a BMSBusManager snapshot callback. Uses the
+    // snapshot's raw voltage, current and temperature, so out-of-range readings still trip
+    void evaluate(const BMSLib::StatusSnapshot& snapshot);
+
+    bool isActive(Condition condition) const;
+    uint8_t getActiveMask() const;          // Bit n set while condition n is raised
+    uint32_t getTickCount() const;
+
+private:
+    struct State {
+        int32_t trip;
+        int32_t clear;
+        uint8_t debounce;
+        uint8_t pending;        // Consecutive ticks pointing at the other state
+        bool enabled;
+        bool active;
+        Handler handler;
+        void* context;
+    };
+
+    BMSLib& _gauge;
+    BMSLib::ReadPlan _plan;
+    State _states[CONDITION_COUNT];
+    Handler _anyHandler;
+    void* _anyContext;
+    bool _gaugeFlags;
+    uint16_t _intervalMs;
+    uint32_t _lastTick;
+    uint32_t _ticks;
+
+    void evaluate(const int32_t* values, uint16_t flags);
+    void update(Condition condition, int32_t value, bool flagged);
+    void notify(Condition condition, Event event, int32_t value);
+    static bool isHighCondition(Condition condition);
+};
+
+#endif // BMSLIB_ALARM_H
@@ -0,0 +1,176 @@
+#include "bmslib_alert.h"
+
+static_assert(BMS_ALERT_MAX_MONITORS >= 1 && BMS_ALERT_MAX_MONITORS <= 4,
+              "BMS_ALERT_MAX_MONITORS must be between 1 and 4");
+
+BMSAlertMonitor* BMSAlertMonitor::_monitors[BMS_ALERT_MAX_MONITORS];
+
+BMSAlertMonitor::BMSAlertMonitor(BMSLib& gauge) :
+    _gauge(gauge),
+    _slot(-1),
+    _pin(0),
+    _alertCount(0),
+    _alertSeen(0),
+    _alertUnread(false),
+    _valid(false),
+    _intervalMs(BMS_ALERT_IDLE_INTERVAL),
+    _lastRead(0),
+    _callback(nullptr),
+    _callbackContext(nullptr) {
+    resetStats();
+}
+
+BMSAlertMonitor::~BMSAlertMonitor() {
+    end();
+}
+
+bool BMSAlertMonitor::begin(uint8_t pin, int edge, uint8_t pinMode) {
+    static void (* const handlers[])() = {
+        alert0,
+#if BMS_ALERT_MAX_MONITORS > 1
+        alert1,
+#endif
+#if BMS_ALERT_MAX_MONITORS > 2
+        alert2,
+#endif
+#if BMS_ALERT_MAX_MONITORS > 3
+        alert3,
+#endif
+    };
+
+    end();
+
+    int interrupt = digitalPinToInterrupt(pin);
+#ifdef NOT_AN_INTERRUPT
+    if (interrupt == NOT_AN_INTERRUPT) {
+        return false;
+    }
+#endif
+
+    for (uint8_t i = 0; i < BMS_ALERT_MAX_MONITORS; i++) {
+        if (_monitors[i] != nullptr) {
+            continue;
+        }
+
+        _slot = i;
+        _pin = pin;
+        _alertSeen = _alertCount;
+        _monitors[i] = this;
+        ::pinMode(pin, pinMode);
+        attachInterrupt(interrupt, handlers[i], edge);
+
+        // Take the first snapshot now so the monitor starts with valid data
+        read(false);
+        return true;
+    }
+    return false;
+}
+
+void BMSAlertMonitor::end() {
+    if (_slot < 0) {
+        return;
+    }
+    detachInterrupt(digitalPinToInterrupt(_pin));
+    _monitors[_slot] = nullptr;
+    _slot = -1;
+}
+
+void BMSAlertMonitor::setIdleInterval(uint32_t intervalMs) {
+    _intervalMs = intervalMs;
+}
+
+void BMSAlertMonitor::setSnapshotCallback(SnapshotCallback callback, void* context) {
+    _callback = callback;
+    _callbackContext = context;
+}
+
+bool BMSAlertMonitor::poll() {
+    // A single-byte load is atomic, so no interrupt masking is needed. Edges that
+    // arrive while reading are picked up by the next poll().
+    uint8_t count = _alertCount;
+    if (count != _alertSeen) {
+        _stats.alerts += static_cast<uint8_t>(count - _alertSeen);
+        _alertSeen = count;
+        _alertUnread = true;
+        return read(true);
+    }
+
+    // An alert whose read failed stays pending; retry without hammering a dead bus
+    if (_alertUnread && millis() - _lastRead >= BMS_ALERT_RETRY_INTERVAL) {
+        return read(true);
+    }
+
+    if (_intervalMs > 0 && millis() - _lastRead >= _intervalMs) {
+        return read(false);
+    }
+    return false;
+}
+
+uint32_t BMSAlertMonitor::getIdleTimeMs() const {
+    if (_alertCount != _alertSeen) {
+        return 0;
+    }
+    uint32_t elapsed = millis() - _lastRead;
+    if (_alertUnread) {
+        return elapsed >= BMS_ALERT_RETRY_INTERVAL ? 0 : BMS_ALERT_RETRY_INTERVAL - elapsed;
+    }
+    if (_intervalMs == 0) {
+        return UINT32_MAX;
+    }
+    return elapsed >= _intervalMs ? 0 : _intervalMs - elapsed;
+}
+
+bool BMSAlertMonitor::isAlertPending() const {
+    return _alertCount != _alertSeen || _alertUnread;
+}
+
+const BMSLib::StatusSnapshot* BMSAlertMonitor::getSnapshot() const {
+    return _valid ? &_snapshot : nullptr;
+}
+
+const BMSAlertMonitor::Stats& BMSAlertMonitor::getStats() const {
+    return _stats;
+}
+
+void BMSAlertMonitor::resetStats() {
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+bool BMSAlertMonitor::read(bool fromAlert) {
+    _lastRead = millis();
+    if (!_gauge.readStatusSnapshot(_snapshot)) {
+        _stats.failures++;
+        return false;
+    }
+
+    _valid = true;
+    if (fromAlert) {
+        _alertUnread = false;
+        _stats.alertReads++;
+    } else {
+        _stats.idleReads++;
+    }
+
+    if (_callback != nullptr) {
+        _callback(_snapshot, fromAlert, _callbackContext);
+    }
+    return true;
+}
+
+void BMS_ISR_ATTR BMSAlertMonitor::handleAlert(uint8_t slot) {
+    BMSAlertMonitor* monitor = _monitors[slot];
+    if (monitor != nullptr) {
+        monitor->_alertCount++;
+    }
+}
+
+void BMS_ISR_ATTR BMSAlertMonitor::alert0() { handleAlert(0); }
+#if BMS_ALERT_MAX_MONITORS > 1
+void BMS_ISR_ATTR BMSAlertMonitor::alert1() { handleAlert(1); }
+#endif
+#if BMS_ALERT_MAX_MONITORS > 2
+void BMS_ISR_ATTR BMSAlertMonitor::alert2() { handleAlert(2); }
+#endif
+#if BMS_ALERT_MAX_MONITORS > 3
+void BMS_ISR_ATTR BMSAlertMonitor::alert3() { handleAlert(3); }
+#endif
@@ -0,0 +1,87 @@
+#ifndef BMSLIB_ALERT_H
+#define BMSLIB_ALERT_H
+
+#include "BMSLib.h"
+
+// Monitors that can be attached at once; each needs its own interrupt trampoline
+#ifndef BMS_ALERT_MAX_MONITORS
+#define BMS_ALERT_MAX_MONITORS  2
+#endif
+
+#define BMS_ALERT_IDLE_INTERVAL 60000   // Background poll when the pin stays quiet (ms)
+#define BMS_ALERT_RETRY_INTERVAL 100    // Retry period for an alert whose read failed (ms)
+
+#if defined(ESP32) || defined(ESP8266)
+#define BMS_ISR_ATTR IRAM_ATTR
+#else
+#define BMS_ISR_ATTR
+#endif
+
+// Samples the gauge when its ALERT/GPOUT pin fires instead of polling continuously.
+// The interrupt only bumps a counter; poll() notices the change from loop() context
+// and takes one burst snapshot. Without alerts a slow background read keeps the
+// snapshot fresh.
+class BMSAlertMonitor {
+public:
+    struct Stats {
+        uint32_t alerts;        // Pin edges seen
+        uint32_t alertReads;    // Snapshots triggered by the pin
+        uint32_t idleReads;     // Background snapshots
+        uint32_t failures;      // Snapshot reads that failed
+    };
+
+    typedef void (*SnapshotCallback)(const BMSLib::StatusSnapshot& snapshot, bool fromAlert, void* context);
+
+    explicit BMSAlertMonitor(BMSLib& gauge);
+    ~BMSAlertMonitor();
+
+    // Attach to the pin; edge is FALLING for the active-low ALERT output
+    bool begin(uint8_t pin, int edge = FALLING, uint8_t pinMode = INPUT_PULLUP);
+    void end();
+
+    void setIdleInterval(uint32_t intervalMs);
+    void setSnapshotCallback(SnapshotCallback callback, void* context = nullptr);
+
+    // Read the gauge if the pin fired or the idle interval passed; true on a new snapshot
+    bool poll();
+
+    // Time the sketch may sleep before poll() has background work, unless the pin fires
+    uint32_t getIdleTimeMs() const;
+    bool isAlertPending() const;    // Pin fired and no snapshot has been read for it yet
+
+    const BMSLib::StatusSnapshot* getSnapshot() const;
+    const Stats& getStats() const;
+    void resetStats();
+
+private:
+    BMSLib& _gauge;
+    int8_t _slot;               // Trampoline index, -1 when detached
+    uint8_t _pin;
+    volatile uint8_t _alertCount;  // Written only by the ISR
+    uint8_t _alertSeen;            // Written only by poll()
+    bool _alertUnread;             // Alert seen but its snapshot read has not succeeded
+    bool _valid;
+    uint32_t _intervalMs;
+    uint32_t _lastRead;
+    SnapshotCallback _callback;
+    void* _callbackContext;
+    BMSLib::StatusSnapshot _snapshot;
+    Stats _stats;
+
+    static BMSAlertMonitor* _monitors[BMS_ALERT_MAX_MONITORS];
+    static void BMS_ISR_ATTR handleAlert(uint8_t slot);
+    static void BMS_ISR_ATTR alert0();
+#if BMS_ALERT_MAX_MONITORS > 1
+    static void BMS_ISR_ATTR alert1();
+#endif
+#if BMS_ALERT_MAX_MONITORS > 2
+    static void BMS_ISR_ATTR alert2();
+#endif
+#if BMS_ALERT_MAX_MONITORS > 3
+    static void BMS_ISR_ATTR alert3();
+#endif
+
+    bool read(bool fromAlert);
+};
+
+#endif // BMSLIB_ALERT_H
@@ -0,0 +1,290 @@
+#include "BMSLib.h"
+
+// Non-blocking mode transitions. Each operation is compiled into a short list of
+// steps; poll() runs steps until one has to wait for the gauge, then returns so the
+// caller can get on with other work. The blocking API waits on these same operations.
+
+BMSLib::OpHandle BMSLib::beginAsync() {
+    if (startOp() == 0) {
+        return 0;
+    }
+    addStep(StepKind::WIRE_BEGIN);
+    addStep(StepKind::WAIT_READY, 0, STARTUP_SETTLE_MS);
+    return _opHandle;
+}
+
+BMSLib::OpHandle BMSLib::enterConfigModeAsync() {
+    if (startOp() == 0) {
+        return 0;
+    }
+    addStep(StepKind::ENTER_CONFIG);
+    return _opHandle;
+}
+
+BMSLib::OpHandle BMSLib::exitConfigModeAsync() {
+    if (startOp() == 0) {
+        return 0;
+    }
+    addStep(StepKind::EXIT_CONFIG);
+    return _opHandle;
+}
+
+BMSLib::OpHandle BMSLib::wakeAsync() {
+    if (startOp() == 0) {
+        return 0;
+    }
+    addStep(StepKind::WRITE, BMS_REG_CNTL, BMS_WAKE_COMMAND);
+    addStep(StepKind::WAIT, 0, MODE_SETTLE_MS);
+    return _opHandle;
+}
+
+BMSLib::OpHandle BMSLib::setPowerModeAsync(PowerMode mode) {
+    if (startOp() == 0) {
+        return 0;
+    }
+
+    // Cannot enter config mode when setting shutdown
+    if (mode == PowerMode::SHUTDOWN) {
+        addStep(StepKind::WRITE, BMS_REG_POWER_MODE, static_cast<uint16_t>(mode));
+        addStep(StepKind::WAIT, 0, RESET_SETTLE_MS);
+        return _opHandle;
+    }
+
+    addStep(StepKind::CONFIG_BEGIN);
+    addStep(StepKind::WRITE, BMS_REG_POWER_MODE, static_cast<uint16_t>(mode));
+    addStep(StepKind::WAIT, 0, MODE_SETTLE_MS);
+    addStep(StepKind::CONFIG_END, 0, 0, STEP_CLEANUP);
+    return _opHandle;
+}
+
+BMSLib::OpHandle BMSLib::setBatteryChemistryAsync(BatteryChemistry chemistry) {
+    if (!isChemistrySupported(chemistry) || startOp() == 0) {
+        return 0;
+    }
+
+    addStep(StepKind::CONFIG_BEGIN);
+    addStep(StepKind::WRITE, BMS_REG_CHEM, static_cast<uint16_t>(chemistry));
+    addStep(StepKind::WAIT, 0, MODE_SETTLE_MS);  // Allow time for chemistry change
+    addStep(StepKind::CONFIG_END, 0, 0, STEP_CLEANUP);
+    return _opHandle;
+}
+
+BMSLib::OpHandle BMSLib::factoryResetAsync() {
+    if (startOp() == 0) {
+        return 0;
+    }
+    invalidateShadow();  // Data flash returns to defaults
+    addStep(StepKind::EXIT_CONFIG, 0, 0, STEP_OPTIONAL);
+    addStep(StepKind::WRITE, BMS_REG_CNTL, BMS_FACTORY_RESET);
+    addStep(StepKind::WAIT, 0, RESET_SETTLE_MS);
+    addStep(StepKind::CHECK_ONLINE);
+    return _opHandle;
+}
+
+BMSLib::OpState BMSLib::poll() {
+    if (_opState != OpState::PENDING) {
+        return _opState;
+    }
+
+    while (_opIndex < _opCount) {
+        const OpStep& step = _opSteps[_opIndex];
+
+        if (_opWaiting) {
+            bool ready = step.kind == StepKind::WAIT_READY && probeReady();
+            if (!ready && millis() - _opWaitStart < _opWaitMs) {
+                return OpState::PENDING;
+            }
+            if (step.kind == StepKind::WAIT_READY && !ready) {
+                _opFailed = true;
+            }
+            _opWaiting = false;
+            finishStep(step);
+            _opIndex++;
+            continue;
+        }
+
+        // After a failure only cleanup steps run, so config mode is always restored
+        if (_opFailed && (step.flags & STEP_CLEANUP) == 0) {
+            _opIndex++;
+            continue;
+        }
+
+        uint16_t settleMs = 0;
+        if (!runStep(step, settleMs)) {
+            if ((step.flags & STEP_OPTIONAL) == 0) {
+                _opFailed = true;
+            }
+            _opIndex++;
+            continue;
+        }
+
+        _opWaiting = true;
+        _opWaitStart = millis();
+        _opWaitMs = settleMs;
+    }
+
+    _opState = _opFailed ? OpState::FAILED : OpState::DONE;
+    return _opState;
+}
+
+BMSLib::OpState BMSLib::getOpState(OpHandle handle) const {
+    if (handle == 0 || handle != _opHandle) {
+        return OpState::IDLE;
+    }
+    return _opState;
+}
+
+bool BMSLib::isBusy() const {
+    return _opState == OpState::PENDING;
+}
+
+BMSLib::OpHandle BMSLib::startOp() {
+    if (_opState == OpState::PENDING) {
+        return 0;
+    }
+
+    _opCount = 0;
+    _opIndex = 0;
+    _opFailed = false;
+    _opWaiting = false;
+    _opScopeHeld = false;
+    _opState = OpState::PENDING;
+
+    // Handles wrap but never return to 0
+    if (++_opHandle == 0) {
+        _opHandle = 1;
+    }
+    return _opHandle;
+}
+
+void BMSLib::addStep(StepKind kind, uint8_t command, uint16_t value, uint8_t flags) {
+    if (_opCount >= BMS_ASYNC_MAX_STEPS) {
+        _opFailed = true;
+        return;
+    }
+    OpStep& step = _opSteps[_opCount++];
+    step.kind = kind;
+    step.flags = flags;
+    step.command = command;
+    step.value = value;
+}
+
+bool BMSLib::runStep(const OpStep& step, uint16_t& settleMs) {
+    _opStepLive = false;
+
+    switch (step.kind) {
+        case StepKind::WIRE_BEGIN:
+            _wire->begin();
+            applyWireTimeout();
+            return true;
+
+        case StepKind::WRITE:
+            return writeWord(step.command, step.value);
+
+        case StepKind::WAIT:
+        case StepKind::WAIT_READY:
+            settleMs = step.value;
+            return true;
+
+        case StepKind::CHECK_ONLINE:
+            return isOnline();
+
+        case StepKind::ENTER_CONFIG:
+            if (_configMode) {
+                return true;
+            }
+            if (!writeWord(BMS_REG_CNTL, BMS_CONFIG_MODE_ENTER)) {
+                return false;
+            }
+            _opStepLive = true;
+            settleMs = CONFIG_SETTLE_MS;
+            return true;
+
+        case StepKind::EXIT_CONFIG:
+            if (!_configMode) {
+                return true;
+            }
+            if (!writeWord(BMS_REG_CNTL, BMS_CONFIG_MODE_EXIT)) {
+                return false;
+            }
+            _opStepLive = true;
+            settleMs = CONFIG_SETTLE_MS;
+            return true;
+
+        case StepKind::CONFIG_BEGIN:
+            // Same rules as beginConfig(): only the outermost scope enters
+            if (_configDepth == 0) {
+                _configScoped = !_configMode;
+                if (_configScoped) {
+                    if (!writeWord(BMS_REG_CNTL, BMS_CONFIG_MODE_ENTER)) {
+                        _configScoped = false;
+                        return false;
+                    }
+                    _opStepLive = true;
+                    settleMs = CONFIG_SETTLE_MS;
+                }
+            }
+            return true;
+
+        case StepKind::CONFIG_END:
+            if (!_opScopeHeld) {
+                return true;
+            }
+            _opScopeHeld = false;
+            if (_opFailed && _session != nullptr) {
+                _session->_failed = true;
+            }
+            if (--_configDepth == 0 && _configScoped) {
+                _configScoped = false;
+                if (!writeWord(BMS_REG_CNTL, BMS_CONFIG_MODE_EXIT)) {
+                    return false;
+                }
+                _opStepLive = true;
+                settleMs = CONFIG_SETTLE_MS;
+            }
+            return true;
+    }
+    return false;
+}
+
+void BMSLib::finishStep(const OpStep& step) {
+    // Mode flags only change once the gauge has had time to settle
+    switch (step.kind) {
+        case StepKind::ENTER_CONFIG:
+            if (_opStepLive) _configMode = true;
+            break;
+
+        case StepKind::EXIT_CONFIG:
+        case StepKind::CONFIG_END:
+            if (_opStepLive) _configMode = false;
+            break;
+
+        case StepKind::CONFIG_BEGIN:
+            if (_opStepLive) _configMode = true;
+            _configDepth++;
+            _opScopeHeld = true;
+            break;
+
+        default:
+            break;
+    }
+}
+
+// One attempt, no retries or error counts: a gauge still starting up NACKs its address
+bool BMSLib::probeReady() {
+    uint8_t control[2];
+    return readOnce(BMS_REG_CNTL, control, sizeof(control)) == Status::OK;
+}
+
+bool BMSLib::waitOp(OpHandle handle) {
+    if (handle == 0) {
+        return false;
+    }
+    while (getOpState(handle) == OpState::PENDING) {
+        poll();
+        if (getOpState(handle) == OpState::PENDING) {
+            yield();
+        }
+    }
+    return getOpState(handle) == OpState::DONE;
+}
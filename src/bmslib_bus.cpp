@@ -0,0 +1,253 @@
+#include "bmslib_bus.h"
+
+BMSBusManager::BMSBusManager() :
+    _muxCount(0),
+    _gaugeCount(0),
+    _cursor(0),
+    _schedule(Schedule::ROUND_ROBIN),
+    _passIntervalMs(0),
+    _passStart(0),
+    _passWaiting(false),
+    _callback(nullptr),
+    _callbackContext(nullptr) {
+    resetStats();
+}
+
+int8_t BMSBusManager::addMux(BMSBus& wire, uint8_t address) {
+    if (_muxCount >= BMS_BUS_MAX_MUXES) {
+        return -1;
+    }
+    Mux& mux = _muxes[_muxCount];
+    mux.wire = &wire;
+    mux.address = address;
+    mux.channel = BMS_MUX_NO_CHANNEL;
+    return _muxCount++;
+}
+
+int8_t BMSBusManager::addGauge(BMSLib& gauge, int8_t mux, uint8_t channel, uint16_t intervalMs) {
+    if (_gaugeCount >= BMS_BUS_MAX_GAUGES || mux < BMS_MUX_NONE || mux >= (int8_t)_muxCount ||
+        (mux != BMS_MUX_NONE && channel > 7)) {
+        return -1;
+    }
+
+    uint8_t index = _gaugeCount++;
+    Endpoint& endpoint = _endpoints[index];
+    endpoint.gauge = &gauge;
+    endpoint.mux = mux;
+    endpoint.channel = mux == BMS_MUX_NONE ? BMS_MUX_NO_CHANNEL : channel;
+    endpoint.valid = false;
+    endpoint.intervalMs = intervalMs;
+    endpoint.failures = 0;
+    endpoint.due = millis();
+    endpoint.stamp = 0;
+
+    // Insert into the visiting order so gauges sharing a channel are adjacent
+    uint8_t position = index;
+    while (position > 0 && sortsBefore(endpoint, _endpoints[_order[position - 1]])) {
+        _order[position] = _order[position - 1];
+        position--;
+    }
+    _order[position] = index;
+    return index;
+}
+
+uint8_t BMSBusManager::getGaugeCount() const {
+    return _gaugeCount;
+}
+
+void BMSBusManager::setSchedule(Schedule schedule) {
+    _schedule = schedule;
+}
+
+void BMSBusManager::setInterval(uint8_t gauge, uint16_t intervalMs) {
+    if (gauge < _gaugeCount) {
+        _endpoints[gauge].intervalMs = intervalMs;
+    }
+}
+
+void BMSBusManager::setPassInterval(uint16_t intervalMs) {
+    _passIntervalMs = intervalMs;
+}
+
+void BMSBusManager::setSnapshotCallback(SnapshotCallback callback, void* context) {
+    _callback = callback;
+    _callbackContext = context;
+}
+
+uint8_t BMSBusManager::poll(uint8_t maxReads) {
+    uint8_t completed = 0;
+    while (maxReads-- > 0) {
+        int8_t next = _schedule == Schedule::DEADLINE ? nextDeadline() : nextRoundRobin();
+        if (next < 0) {
+            break;  // Nothing due
+        }
+        if (readGauge(next)) {
+            completed++;
+        }
+    }
+    return completed;
+}
+
+const BMSLib::StatusSnapshot* BMSBusManager::getSnapshot(uint8_t gauge) const {
+    if (gauge >= _gaugeCount || !_endpoints[gauge].valid) {
+        return nullptr;
+    }
+    return &_endpoints[gauge].snapshot;
+}
+
+uint32_t BMSBusManager::getSnapshotAge(uint8_t gauge) const {
+    if (gauge >= _gaugeCount || !_endpoints[gauge].valid) {
+        return UINT32_MAX;
+    }
+    return millis() - _endpoints[gauge].stamp;
+}
+
+uint16_t BMSBusManager::getFailureCount(uint8_t gauge) const {
+    return gauge < _gaugeCount ? _endpoints[gauge].failures : 0;
+}
+
+BMSLib* BMSBusManager::select(uint8_t gauge) {
+    if (gauge >= _gaugeCount || !route(_endpoints[gauge])) {
+        return nullptr;
+    }
+    return _endpoints[gauge].gauge;
+}
+
+const BMSBusManager::Stats& BMSBusManager::getStats() const {
+    return _stats;
+}
+
+void BMSBusManager::resetStats() {
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+int8_t BMSBusManager::nextRoundRobin() {
+    if (_gaugeCount == 0) {
+        return -1;
+    }
+
+    // A pass starts at the first gauge in sorted order and may be rate limited
+    if (_cursor == 0) {
+        if (_passWaiting) {
+            if (millis() - _passStart < _passIntervalMs) {
+                return -1;
+            }
+            _passWaiting = false;
+        }
+        _passStart = millis();
+    }
+
+    int8_t next = _order[_cursor];
+    if (++_cursor >= _gaugeCount) {
+        _cursor = 0;
+        _passWaiting = _passIntervalMs > 0;
+        _stats.passes++;
+        _stats.lastPassMs = millis() - _passStart;
+    }
+    return next;
+}
+
+int8_t BMSBusManager::nextDeadline() {
+    uint32_t now = millis();
+    int8_t best = -1;
+    int8_t bestLocal = -1;
+
+    for (uint8_t i = 0; i < _gaugeCount; i++) {
+        const Endpoint& endpoint = _endpoints[_order[i]];
+        int32_t lateness = (int32_t)(now - endpoint.due);
+        if (lateness < 0) {
+            continue;
+        }
+
+        // A gauge overdue by a whole interval wins outright, so no channel starves
+        if (endpoint.intervalMs > 0 && lateness >= (int32_t)endpoint.intervalMs) {
+            return _order[i];
+        }
+
+        if (best < 0 || (int32_t)(endpoint.due - _endpoints[best].due) < 0) {
+            best = _order[i];
+        }
+
+        // Prefer gauges reachable without a mux switch
+        bool local = endpoint.mux == BMS_MUX_NONE ||
+                     _muxes[endpoint.mux].channel == (uint8_t)(1 << endpoint.channel);
+        if (local && (bestLocal < 0 || (int32_t)(endpoint.due - _endpoints[bestLocal].due) < 0)) {
+            bestLocal = _order[i];
+        }
+    }
+    return bestLocal >= 0 ? bestLocal : best;
+}
+
+bool BMSBusManager::route(const Endpoint& endpoint) {
+    BMSBus* wire = &endpoint.gauge->getWire();
+
+    // Close channels on other muxes of the same bus; they may expose the same address
+    for (uint8_t i = 0; i < _muxCount; i++) {
+        Mux& mux = _muxes[i];
+        if (mux.wire != wire || (int8_t)i == endpoint.mux || mux.channel == 0) {
+            continue;
+        }
+        if (!writeMux(mux, 0)) {
+            return false;
+        }
+    }
+
+    if (endpoint.mux == BMS_MUX_NONE) {
+        return true;
+    }
+
+    Mux& mux = _muxes[endpoint.mux];
+    uint8_t mask = 1 << endpoint.channel;
+    if (mux.channel == mask) {
+        return true;
+    }
+    return writeMux(mux, mask);
+}
+
+bool BMSBusManager::writeMux(Mux& mux, uint8_t channelMask) {
+    mux.wire->beginTransmission(mux.address);
+    mux.wire->write(channelMask);
+    _stats.transactions++;
+    _stats.bytes += 2;
+    _stats.muxSwitches++;
+    if (mux.wire->endTransmission() != 0) {
+        mux.channel = BMS_MUX_NO_CHANNEL;
+        return false;
+    }
+    mux.channel = channelMask;
+    return true;
+}
+
+bool BMSBusManager::sortsBefore(const Endpoint& a, const Endpoint& b) const {
+    BMSBus* wireA = &a.gauge->getWire();
+    BMSBus* wireB = &b.gauge->getWire();
+    if (wireA != wireB) {
+        return wireA < wireB;
+    }
+    if (a.mux != b.mux) {
+        return a.mux < b.mux;
+    }
+    return a.channel < b.channel;
+}
+
+bool BMSBusManager::readGauge(uint8_t index) {
+    Endpoint& endpoint = _endpoints[index];
+    endpoint.due = millis() + endpoint.intervalMs;
+
+    if (!route(endpoint) || !endpoint.gauge->readStatusSnapshot(endpoint.snapshot)) {
+        endpoint.failures++;
+        _stats.failures++;
+        return false;
+    }
+
+    endpoint.valid = true;
+    endpoint.stamp = millis();
+    _stats.snapshots++;
+    _stats.transactions += endpoint.snapshot.transactions;
+    _stats.bytes += endpoint.snapshot.bytes;
+
+    if (_callback != nullptr) {
+        _callback(index, endpoint.snapshot, _callbackContext);
+    }
+    return true;
+}
@@ -0,0 +1,111 @@
+#ifndef BMSLIB_BUS_H
+#define BMSLIB_BUS_H
+
+#include "BMSLib.h"
+
+// Bus manager limits
+#ifndef BMS_BUS_MAX_GAUGES
+#define BMS_BUS_MAX_GAUGES      16
+#endif
+#ifndef BMS_BUS_MAX_MUXES
+#define BMS_BUS_MAX_MUXES       4
+#endif
+
+#define BMS_MUX_DEFAULT_ADDRESS 0x70    // TCA9548A with A0-A2 low
+#define BMS_MUX_NONE            -1      // Gauge sits directly on the bus
+#define BMS_MUX_NO_CHANNEL      0xFF
+
+// Polls many gauges spread over one or more I2C buses, optionally behind
+// TCA9548A-style multiplexers. Each poll() call performs a bounded amount of work:
+// it picks the next gauge by round-robin or earliest deadline, switches mux channels
+// only when needed, and stores a burst StatusSnapshot for that gauge.
+class BMSBusManager {
+public:
+    enum class Schedule : uint8_t {
+        ROUND_ROBIN,    // Visit gauges in bus/mux/channel order
+        DEADLINE        // Earliest-due gauge first, per-gauge interval
+    };
+
+    // Aggregated throughput counters
+    struct Stats {
+        uint32_t snapshots;        // Successful gauge snapshots
+        uint32_t failures;         // Failed snapshots or mux selects
+        uint32_t muxSwitches;      // Mux channel writes
+        uint32_t transactions;     // Gauge and mux I2C transactions
+        uint32_t bytes;            // Gauge and mux bytes on the wire
+        uint32_t passes;           // Completed round-robin passes
+        uint32_t lastPassMs;       // Duration of the last complete pass
+    };
+
+    typedef void (*SnapshotCallback)(uint8_t gauge, const BMSLib::StatusSnapshot& snapshot, void* context);
+
+    BMSBusManager();
+
+    // Topology
+    int8_t addMux(BMSBus& wire, uint8_t address = BMS_MUX_DEFAULT_ADDRESS);
+    int8_t addGauge(BMSLib& gauge, int8_t mux = BMS_MUX_NONE,
+                    uint8_t channel = BMS_MUX_NO_CHANNEL, uint16_t intervalMs = 0);
+    uint8_t getGaugeCount() const;
+
+    // Scheduling
+    void setSchedule(Schedule schedule);
+    void setInterval(uint8_t gauge, uint16_t intervalMs);
+    void setPassInterval(uint16_t intervalMs);  // Round-robin: minimum time per pass
+    void setSnapshotCallback(SnapshotCallback callback, void* context = nullptr);
+
+    // Service up to maxReads gauges that are due; returns the number read successfully
+    uint8_t poll(uint8_t maxReads = 1);
+
+    // Latest results
+    const BMSLib::StatusSnapshot* getSnapshot(uint8_t gauge) const;
+    uint32_t getSnapshotAge(uint8_t gauge) const;
+    uint16_t getFailureCount(uint8_t gauge) const;
+
+    // Route the bus to a gauge for direct calls; returns nullptr if the mux select fails
+    BMSLib* select(uint8_t gauge);
+
+    const Stats& getStats() const;
+    void resetStats();
+
+private:
+    struct Mux {
+        BMSBus* wire;
+        uint8_t address;
+        uint8_t channel;           // Enabled channel mask as written, BMS_MUX_NO_CHANNEL if unknown
+    };
+
+    struct Endpoint {
+        BMSLib* gauge;
+        int8_t mux;
+        uint8_t channel;
+        bool valid;                // Snapshot holds data
+        uint16_t intervalMs;
+        uint16_t failures;
+        uint32_t due;              // millis() of the next scheduled read
+        uint32_t stamp;            // millis() of the last successful read
+        BMSLib::StatusSnapshot snapshot;
+    };
+
+    Mux _muxes[BMS_BUS_MAX_MUXES];
+    Endpoint _endpoints[BMS_BUS_MAX_GAUGES];
+    uint8_t _order[BMS_BUS_MAX_GAUGES];  // Endpoint indices sorted by bus, mux, channel
+    uint8_t _muxCount;
+    uint8_t _gaugeCount;
+    uint8_t _cursor;
+    Schedule _schedule;
+    uint16_t _passIntervalMs;
+    uint32_t _passStart;
+    bool _passWaiting;
+    SnapshotCallback _callback;
+    void* _callbackContext;
+    Stats _stats;
+
+    int8_t nextRoundRobin();
+    int8_t nextDeadline();
+    bool route(const Endpoint& endpoint);
+    bool writeMux(Mux& mux, uint8_t channel);
+    bool sortsBefore(const Endpoint& a, const Endpoint& b) const;
+    bool readGauge(uint8_t index);
+};
+
+#endif // BMSLIB_BUS_H
@@ -0,0 +1,227 @@
+#include "BMSLib.h"
+
+// Per-register read cache under readWord(). Each cached register has a TTL; fast
+// changing measurements expire quickly, configuration registers stay valid until a
+// write invalidates them. Burst status reads refresh any cacheable register they cover.
+
+void BMSLib::enableCache(bool enable) {
+    _cacheEnabled = enable;
+    invalidateCache();
+}
+
+bool BMSLib::setCacheTtl(uint8_t command, uint16_t ttlMs) {
+#if BMS_READ_CACHE_ENTRIES > 0
+    CacheEntry* entry = cacheSlot(command, true);
+    if (entry == nullptr) {
+        return false;  // Every slot is pinned
+    }
+    entry->flags = CACHE_USED | CACHE_PINNED;
+    entry->ttlMs = ttlMs;
+    return true;
+#else
+    (void)command;
+    (void)ttlMs;
+    return false;
+#endif
+}
+
+void BMSLib::invalidateCache() {
+#if BMS_READ_CACHE_ENTRIES > 0
+    for (uint8_t i = 0; i < BMS_READ_CACHE_ENTRIES; i++) {
+        _cache[i].flags &= ~CACHE_VALID;
+    }
+#endif
+}
+
+const BMSLib::CacheStats& BMSLib::getCacheStats() const {
+    return _cacheStats;
+}
+
+void BMSLib::resetCacheStats() {
+    _cacheStats.hits = 0;
+    _cacheStats.misses = 0;
+}
+
+uint16_t BMSLib::defaultCacheTtl(uint8_t command) {
+    switch (command) {
+        // Fast-changing measurements and safety flags
+        case BMS_REG_CURRENT:
+        case BMS_REG_AI:
+        case BMS_REG_FLAGS:
+        case BMS_REG_FLAGSB:
+            return 20;
+
+        case BMS_REG_VOLT:
+        case BMS_REG_AP:
+            return 100;
+
+        // Slow-moving gauge state
+        case BMS_REG_SOC:
+        case BMS_REG_RM:
+        case BMS_REG_FCC:
+        case BMS_REG_TEMP:
+        case BMS_REG_INTTEMP:
+        case BMS_REG_ATTE:
+        case BMS_REG_ATTF:
+        case BMS_REG_PCHG:
+        case BMS_REG_DOD0T:
+        case BMS_REG_AE:
+        case BMS_REG_CHGV:
+        case BMS_REG_CHGI:
+            return 1000;
+
+        case BMS_REG_CC:
+        case BMS_REG_SOH:
+            return 60000;
+
+        // Configuration and identity; only a write changes these
+        case BMS_REG_SERNUM:
+        case BMS_REG_PKCFG:
+        case BMS_REG_DCAP:
+        case BMS_REG_CAL_STATUS:
+            return BMS_CACHE_TTL_STATIC;
+
+        // CHEM..SHUTDOWN_V (0x40-0x44) read through the BlockData window, whose contents
+        // follow the selected data flash block, so they fall through to uncached
+
+        default:
+            return BMS_CACHE_TTL_NONE;
+    }
+}
+
+uint8_t BMSLib::cacheRank(const CacheEntry& entry) {
+    if ((entry.flags & CACHE_USED) == 0) {
+        return 0;
+    }
+    return (entry.flags & CACHE_VALID) ? 2 : 1;
+}
+
+BMSLib::CacheEntry* BMSLib::cacheSlot(uint8_t command, bool allocate) {
+#if BMS_READ_CACHE_ENTRIES > 0
+    CacheEntry* victim = nullptr;
+    for (uint8_t i = 0; i < BMS_READ_CACHE_ENTRIES; i++) {
+        CacheEntry& entry = _cache[i];
+        if ((entry.flags & CACHE_USED) && entry.command == command) {
+            return &entry;
+        }
+        if (!allocate || (entry.flags & CACHE_PINNED)) {
+            continue;
+        }
+
+        // Prefer free slots, then invalid ones, then the oldest value
+        if (victim == nullptr || cacheRank(entry) < cacheRank(*victim) ||
+            (cacheRank(entry) == cacheRank(*victim) && (int32_t)(entry.stamp - victim->stamp) < 0)) {
+            victim = &entry;
+        }
+    }
+
+    if (victim != nullptr) {
+        victim->command = command;
+        victim->flags = CACHE_USED;
+        victim->ttlMs = defaultCacheTtl(command);
+    }
+    return victim;
+#else
+    (void)command;
+    (void)allocate;
+    return nullptr;
+#endif
+}
+
+bool BMSLib::cacheLookup(uint8_t command, uint16_t& value) {
+    if (!_cacheEnabled) {
+        return false;
+    }
+
+    CacheEntry* entry = cacheSlot(command, false);
+    uint16_t ttl = entry != nullptr ? entry->ttlMs : defaultCacheTtl(command);
+    if (ttl == BMS_CACHE_TTL_NONE) {
+        return false;  // Not a cacheable register; not counted
+    }
+
+    if (entry != nullptr && (entry->flags & CACHE_VALID) &&
+        (ttl == BMS_CACHE_TTL_STATIC || millis() - entry->stamp < ttl)) {
+        value = entry->value;
+        _cacheStats.hits++;
+        return true;
+    }
+
+    _cacheStats.misses++;
+    return false;
+}
+
+void BMSLib::cacheStore(uint8_t command, uint16_t value) {
+    if (!_cacheEnabled) {
+        return;
+    }
+
+    CacheEntry* entry = cacheSlot(command, false);
+    if (entry == nullptr) {
+        if (defaultCacheTtl(command) == BMS_CACHE_TTL_NONE) {
+            return;
+        }
+        entry = cacheSlot(command, true);
+        if (entry == nullptr) {
+            return;
+        }
+    }
+    if (entry->ttlMs == BMS_CACHE_TTL_NONE) {
+        return;
+    }
+
+    entry->value = value;
+    entry->stamp = millis();
+    entry->flags |= CACHE_VALID;
+}
+
+void BMSLib::cacheStoreBlock(uint8_t command, const uint8_t* data, uint8_t length) {
+    if (!_cacheEnabled) {
+        return;
+    }
+
+    // Refresh only registers that are already cached, so a wide burst cannot
+    // evict values the caller is actually reusing
+    for (uint8_t offset = 0; offset + 1 < length; offset++) {
+        CacheEntry* entry = cacheSlot(command + offset, false);
+        if (entry != nullptr && entry->ttlMs != BMS_CACHE_TTL_NONE) {
+            entry->value = (data[offset + 1] << 8) | data[offset];
+            entry->stamp = millis();
+            entry->flags |= CACHE_VALID;
+        }
+    }
+}
+
+void BMSLib::cacheInvalidate(uint8_t command, uint8_t length) {
+#if BMS_READ_CACHE_ENTRIES > 0
+    if (!_cacheEnabled) {
+        return;
+    }
+
+    // Control commands and data flash commits can change any register
+    if (command == BMS_REG_CNTL ||
+        (command <= BMS_REG_BLOCKDATA_CKSUM && command + length > BMS_REG_BLOCKDATA_CKSUM)) {
+        invalidateCache();
+        return;
+    }
+
+    // Selecting a block (DFCLS, DFBLK, BlockDataControl) replaces the whole BlockData
+    // window, so registers pinned there with setCacheTtl() go stale too
+    uint8_t from = command;
+    uint16_t to = command + length;
+    if (command == BMS_REG_BLOCKDATA_CTRL || (command <= BMS_REG_DFBLK && to > BMS_REG_DFCLS)) {
+        if (from > BMS_REG_BLOCKDATA) from = BMS_REG_BLOCKDATA;
+        if (to < BMS_REG_BLOCKDATA + BMS_DATAFLASH_BLOCK_SIZE) to = BMS_REG_BLOCKDATA + BMS_DATAFLASH_BLOCK_SIZE;
+    }
+
+    // Word registers overlap, so a write also touches the one starting a byte earlier
+    for (uint8_t i = 0; i < BMS_READ_CACHE_ENTRIES; i++) {
+        CacheEntry& entry = _cache[i];
+        if ((entry.flags & CACHE_USED) && entry.command + 2 > from && entry.command < to) {
+            entry.flags &= ~CACHE_VALID;
+        }
+    }
+#else
+    (void)command;
+    (void)length;
+#endif
+}
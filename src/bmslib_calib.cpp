@@ -0,0 +1,249 @@
+#include "bmslib_calib.h"
+
+namespace {
+
+// Sample fields for each quantity; all three fall in one burst (0x08-0x11)
+const BMSLib::Field QUANTITY_FIELD[] = {
+    BMSLib::Field::VOLTAGE,
+    BMSLib::Field::CURRENT,
+    BMSLib::Field::TEMPERATURE
+};
+
+// Two-sided 95% Student t, x100, for 1-10 degrees of freedom
+const uint16_t STUDENT_T95[] = { 1271, 430, 318, 278, 257, 245, 236, 231, 226, 223 };
+
+const uint16_t MAX_SAMPLE_LIMIT = 1024;     // Keeps n * sum(d^2) inside 64 bits for 16-bit readings
+
+}  // namespace
+
+static_assert(sizeof(QUANTITY_FIELD) / sizeof(QUANTITY_FIELD[0]) == BMSCalibrationSampler::QUANTITY_COUNT,
+              "QUANTITY_FIELD must cover every quantity");
+
+BMSCalibrationSampler::BMSCalibrationSampler(BMSLib& gauge) :
+    _gauge(gauge),
+    _intervalMs(BMS_CAL_SAMPLE_INTERVAL),
+    _minSamples(BMS_CAL_MIN_SAMPLES),
+    _maxSamples(BMS_CAL_MAX_SAMPLES),
+    _lastSample(0),
+    _running(false),
+    _quantity(VOLTAGE),
+    _bound(0),
+    _pointQuantity(VOLTAGE),
+    _pointCount(0) {
+    uint32_t fields = 0;
+    for (uint8_t i = 0; i < QUANTITY_COUNT; i++) {
+        fields |= BMSLib::fieldMask(QUANTITY_FIELD[i]);
+    }
+    BMSLib::compileReadPlan(fields, _plan);
+    memset(_accumulators, 0, sizeof(_accumulators));
+    memset(_estimates, 0, sizeof(_estimates));
+}
+
+void BMSCalibrationSampler::setSampleInterval(uint16_t intervalMs) {
+    _intervalMs = intervalMs;
+}
+
+void BMSCalibrationSampler::setSampleLimits(uint16_t minSamples, uint16_t maxSamples) {
+    // Two samples are the least that give a spread
+    _minSamples = minSamples < 2 ? 2 : minSamples;
+    _maxSamples = maxSamples > MAX_SAMPLE_LIMIT ? MAX_SAMPLE_LIMIT : maxSamples;
+    if (_maxSamples < _minSamples) {
+        _maxSamples = _minSamples;
+    }
+}
+
+bool BMSCalibrationSampler::start(Quantity quantity, uint32_t bound) {
+    if (quantity >= QUANTITY_COUNT) {
+        return false;
+    }
+
+    _quantity = quantity;
+    _bound = bound;
+    memset(_accumulators, 0, sizeof(_accumulators));
+    memset(_estimates, 0, sizeof(_estimates));
+    _running = true;
+    return true;
+}
+
+bool BMSCalibrationSampler::poll() {
+    if (!_running) {
+        return false;
+    }
+
+    const Estimate& estimate = _estimates[_quantity];
+    if (estimate.count > 0 && millis() - _lastSample < _intervalMs) {
+        return true;
+    }
+
+    _lastSample = millis();
+    if (!sample()) {
+        _running = false;
+        return false;
+    }
+
+    if (estimate.count >= _minSamples && estimate.halfWidth <= _bound) {
+        _estimates[_quantity].converged = true;
+        _running = false;
+    } else if (estimate.count >= _maxSamples) {
+        _running = false;
+    }
+    return _running;
+}
+
+bool BMSCalibrationSampler::run() {
+    while (poll()) {
+        yield();
+    }
+    return _estimates[_quantity].converged;
+}
+
+void BMSCalibrationSampler::stop() {
+    _running = false;
+}
+
+bool BMSCalibrationSampler::isRunning() const {
+    return _running;
+}
+
+const BMSCalibrationSampler::Estimate& BMSCalibrationSampler::getEstimate(Quantity quantity) const {
+    return _estimates[quantity < QUANTITY_COUNT ? quantity : VOLTAGE];
+}
+
+bool BMSCalibrationSampler::addPoint(int32_t actual) {
+    const Estimate& estimate = _estimates[_quantity];
+    if (_running || estimate.count == 0 || _pointCount >= BMS_CAL_MAX_POINTS) {
+        return false;
+    }
+    // A fit only makes sense within one quantity
+    if (_pointCount > 0 && _pointQuantity != _quantity) {
+        return false;
+    }
+
+    _pointQuantity = _quantity;
+    _measured[_pointCount] = estimate.mean;
+    _actual[_pointCount] = actual;
+    _pointCount++;
+    return true;
+}
+
+void BMSCalibrationSampler::clearPoints() {
+    _pointCount = 0;
+}
+
+uint8_t BMSCalibrationSampler::getPointCount() const {
+    return _pointCount;
+}
+
+bool BMSCalibrationSampler::getFit(Fit& fit) const {
+    memset(&fit, 0, sizeof(fit));
+    if (_pointCount == 0) {
+        return false;
+    }
+
+    int64_t sumMeasured = 0;
+    int64_t sumActual = 0;
+    for (uint8_t i = 0; i < _pointCount; i++) {
+        sumMeasured += _measured[i];
+        sumActual += _actual[i];
+    }
+    fit.points = _pointCount;
+    fit.measured = static_cast<int32_t>(sumMeasured / _pointCount);
+    fit.actual = static_cast<int32_t>(sumActual / _pointCount);
+
+    // One point: gain only, as the single-value calibrate functions do
+    if (_pointCount == 1) {
+        if (fit.measured == 0) {
+            return false;
+        }
+        fit.gain = static_cast<int32_t>(static_cast<int64_t>(fit.actual) * 1000 / fit.measured);
+        return true;
+    }
+
+    // Deviations from the centre keep the products well inside 64 bits
+    int64_t sxx = 0;
+    int64_t sxy = 0;
+    for (uint8_t i = 0; i < _pointCount; i++) {
+        int64_t dx = _measured[i] - fit.measured;
+        int64_t dy = _actual[i] - fit.actual;
+        sxx += dx * dx;
+        sxy += dx * dy;
+    }
+    if (sxx == 0) {
+        return false;  // Every point at the same reading: the slope is undefined
+    }
+
+    fit.gain = static_cast<int32_t>(sxy * 1000 / sxx);
+    fit.offset = fit.actual - static_cast<int32_t>(sxy * fit.measured / sxx);
+    return true;
+}
+
+bool BMSCalibrationSampler::sample() {
+    BMSLib::FieldValues values;
+    if (!_gauge.executeReadPlan(_plan, values)) {
+        return false;
+    }
+
+    for (uint8_t i = 0; i < QUANTITY_COUNT; i++) {
+        uint16_t raw = values.get(QUANTITY_FIELD[i]);
+        int32_t value = i == CURRENT ? static_cast<int16_t>(raw) : static_cast<int32_t>(raw);
+        update(_accumulators[i], _estimates[i], value);
+    }
+    return true;
+}
+
+void BMSCalibrationSampler::update(Accumulator& accumulator, Estimate& estimate, int32_t value) {
+    if (estimate.count == 0) {
+        accumulator.first = value;
+    }
+    int64_t deviation = value - accumulator.first;
+    accumulator.sum += deviation;
+    accumulator.sumSquares += static_cast<uint64_t>(deviation * deviation);
+    estimate.count++;
+
+    const int64_t n = estimate.count;
+    estimate.mean = accumulator.first * 100 +
+                    static_cast<int32_t>((accumulator.sum * 200 + (accumulator.sum >= 0 ? n : -n)) / (2 * n));
+
+    if (n < 2) {
+        estimate.halfWidth = 0xFFFFFFFFUL;
+        return;
+    }
+
+    // n * sum(d^2) - sum(d)^2 is exact; variance of the mean = that / (n^2 (n - 1)).
+    // Scaling to hundredths (x10^4 under the root) goes through quotient and remainder,
+    // since spread * 10^4 comes within a factor of two of 2^64 at the sample limit
+    uint64_t spread = static_cast<uint64_t>(n) * accumulator.sumSquares -
+                      static_cast<uint64_t>(accumulator.sum * accumulator.sum);
+    const uint64_t divisor = static_cast<uint64_t>(n * n * (n - 1));
+    uint64_t variance = spread / divisor * 10000 + spread % divisor * 10000 / divisor;
+    uint32_t standardError = isqrt(variance);
+    estimate.halfWidth = static_cast<uint32_t>(
+        (static_cast<uint64_t>(standardError) * studentT95(estimate.count - 1) + 50) / 100);
+}
+
+uint16_t BMSCalibrationSampler::studentT95(uint16_t degrees) {
+    // Past the table each band takes the value just below it, which keeps the bound conservative
+    if (degrees <= 10) return STUDENT_T95[degrees - 1];
+    if (degrees <= 15) return 223;
+    if (degrees <= 20) return 213;
+    if (degrees <= 30) return 209;
+    return 204;
+}
+
+uint32_t BMSCalibrationSampler::isqrt(uint64_t value) {
+    uint64_t root = 0;
+    uint64_t bit = 1ULL << 62;
+    while (bit > value) {
+        bit >>= 2;
+    }
+    while (bit != 0) {
+        if (value >= root + bit) {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return static_cast<uint32_t>(root);
+}
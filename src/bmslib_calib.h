@@ -0,0 +1,100 @@
+#ifndef BMSLIB_CALIB_H
+#define BMSLIB_CALIB_H
+
+#include "BMSLib.h"
+
+// Reference points kept for a multi-point fit
+#ifndef BMS_CAL_MAX_POINTS
+#define BMS_CAL_MAX_POINTS      8
+#endif
+
+#define BMS_CAL_SAMPLE_INTERVAL 1000    // Default; the gauge updates its readings about once a second
+#define BMS_CAL_MIN_SAMPLES     4       // Default floor before the bound may stop a run
+#define BMS_CAL_MAX_SAMPLES     64      // Default ceiling when the bound is never met
+
+// Averages the gauge's own voltage, current and temperature readings for calibration.
+// Every sample is one burst read of all three. A run keeps a running mean and a 95%
+// confidence half-width (Student t) and stops as soon as the half-width of each
+// watched quantity is within its bound, so a quiet unit finishes in a few samples
+// and a noisy one keeps sampling up to the limit. Means paired with reference meter
+// readings build a least-squares gain/offset fit across several calibration points,
+// which reports how linear the unit is.
+// Means, bounds and reference values are in hundredths of the quantity's unit
+// (0.01 mV, 0.01 mA, 0.001 K), so averaging keeps the precision it gains.
+class BMSCalibrationSampler {
+public:
+    enum Quantity : uint8_t {
+        VOLTAGE,        // mV
+        CURRENT,        // mA
+        TEMPERATURE,    // 0.1K
+        QUANTITY_COUNT
+    };
+
+    struct Estimate {
+        uint16_t count;         // Samples taken
+        int32_t mean;           // Hundredths of the unit
+        uint32_t halfWidth;     // 95% confidence half-width, hundredths of the unit
+        bool converged;         // Bound met, rather than stopped at the sample limit
+    };
+
+    // actual = measured * gain / 1000 + offset
+    struct Fit {
+        int32_t gain;           // Thousandths, the scale of the gauge's gain registers
+        int32_t offset;         // Hundredths of the unit
+        int32_t measured;       // Centre of the points (mean of the gauge readings)
+        int32_t actual;         // Centre of the reference readings
+        uint8_t points;
+    };
+
+    explicit BMSCalibrationSampler(BMSLib& gauge);
+
+    void setSampleInterval(uint16_t intervalMs);
+    void setSampleLimits(uint16_t minSamples, uint16_t maxSamples);
+
+    // Watch one quantity, stopping once its half-width is at most bound (hundredths)
+    bool start(Quantity quantity, uint32_t bound);
+    bool poll();            // Take a sample when due; false once the run has stopped
+    bool run();             // Block until stopped; true if the bound was met
+    void stop();
+    bool isRunning() const;
+
+    const Estimate& getEstimate(Quantity quantity) const;
+
+    // Pair the last run's mean with a reference reading (hundredths of the unit)
+    bool addPoint(int32_t actual);
+    void clearPoints();
+    uint8_t getPointCount() const;
+    // Report only: the gauge stores a gain without an offset, so a fit is for judging a unit,
+    // not for writing back. Calibrate from one run's mean with calibrateVoltage() and friends
+    bool getFit(Fit& fit) const;
+
+private:
+    struct Accumulator {
+        int32_t first;          // Sums are taken relative to the first sample
+        int64_t sum;
+        uint64_t sumSquares;
+    };
+
+    BMSLib& _gauge;
+    BMSLib::ReadPlan _plan;
+    uint16_t _intervalMs;
+    uint16_t _minSamples;
+    uint16_t _maxSamples;
+    uint32_t _lastSample;
+    bool _running;
+    Quantity _quantity;
+    uint32_t _bound;
+    Accumulator _accumulators[QUANTITY_COUNT];
+    Estimate _estimates[QUANTITY_COUNT];
+    Quantity _pointQuantity;
+    uint8_t _pointCount;
+    int32_t _measured[BMS_CAL_MAX_POINTS];
+    int32_t _actual[BMS_CAL_MAX_POINTS];
+
+    bool sample();
+    static void update(Accumulator& accumulator, Estimate& estimate, int32_t value);
+    static uint16_t studentT95(uint16_t degrees);
+    static uint32_t isqrt(uint64_t value);
+};
+
+#endif // BMSLIB_CALIB_H
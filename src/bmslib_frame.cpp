@@ -0,0 +1,191 @@
+#include "bmslib_frame.h"
+
+#include <string.h>
+
+namespace {
+
+void putU16(uint8_t*& out, uint16_t value) {
+    *out++ = value & 0xFF;
+    *out++ = value >> 8;
+}
+
+void putU32(uint8_t*& out, uint32_t value) {
+    putU16(out, value & 0xFFFF);
+    putU16(out, value >> 16);
+}
+
+uint16_t getU16(const uint8_t*& in) {
+    uint16_t value = in[0] | (in[1] << 8);
+    in += 2;
+    return value;
+}
+
+uint32_t getU32(const uint8_t*& in) {
+    uint32_t low = getU16(in);
+    return low | ((uint32_t)getU16(in) << 16);
+}
+
+}  // namespace
+
+size_t BMSFrame::encodedSize(uint16_t present) {
+    size_t size = BMS_FRAME_HEADER_SIZE + BMS_FRAME_CRC_SIZE;
+    for (uint8_t field = 0; field < FIELD_COUNT; field++) {
+        if (present & (1u << field)) {
+            size += fieldSize(field);
+        }
+    }
+    return size;
+}
+
+size_t BMSFrame::encode(const Record& record, uint8_t sequence, uint8_t* out, size_t size) {
+    uint16_t present = record.present;
+    size_t length = encodedSize(present);
+    if (size < length) {
+        return 0;
+    }
+
+    uint8_t* p = out;
+    *p++ = BMS_FRAME_SYNC;
+    *p++ = BMS_FRAME_VERSION;
+    *p++ = sequence;
+    putU16(p, present);
+
+    if (present & mask(TIMESTAMP))             putU32(p, record.timestamp);
+    if (present & mask(VOLTAGE))               putU16(p, record.voltage);
+    if (present & mask(CURRENT))               putU16(p, record.current);
+    if (present & mask(AVERAGE_CURRENT))       putU16(p, record.averageCurrent);
+    if (present & mask(TEMPERATURE))           putU16(p, record.temperature);
+    if (present & mask(STATE_OF_CHARGE))       *p++ = record.stateOfCharge;
+    if (present & mask(STATE_OF_HEALTH))       *p++ = record.stateOfHealth;
+    if (present & mask(REMAINING_CAPACITY))    putU16(p, record.remainingCapacity);
+    if (present & mask(FULL_CAPACITY))         putU16(p, record.fullCapacity);
+    if (present & mask(FLAGS))                 putU16(p, record.flags);
+    if (present & mask(CONTROL))               putU16(p, record.control);
+    if (present & mask(MAX_TEMP))              putU16(p, record.maxTemp);
+    if (present & mask(MIN_TEMP))              putU16(p, record.minTemp);
+    if (present & mask(MAX_CHARGE_CURRENT))    putU16(p, record.maxChargeCurrent);
+    if (present & mask(MAX_DISCHARGE_CURRENT)) putU16(p, record.maxDischargeCurrent);
+    if (present & mask(PACK_VOLTAGE_RANGE)) {
+        putU16(p, record.maxPackVoltage);
+        putU16(p, record.minPackVoltage);
+    }
+
+    putU16(p, crc16(out + 1, p - out - 1));
+    return length;
+}
+
+BMSFrame::DecodeResult BMSFrame::decode(const uint8_t* data, size_t length, Record& record,
+                                        uint8_t& sequence, size_t& consumed) {
+    consumed = 0;
+    if (length == 0) {
+        return DecodeResult::INCOMPLETE;
+    }
+
+    // Resynchronise on the next sync byte after anything that is not a valid frame
+    if (data[0] != BMS_FRAME_SYNC) {
+        const void* next = memchr(data, BMS_FRAME_SYNC, length);
+        consumed = next != nullptr ? (const uint8_t*)next - data : length;
+        return DecodeResult::BAD_SYNC;
+    }
+    if (length < BMS_FRAME_HEADER_SIZE) {
+        return DecodeResult::INCOMPLETE;
+    }
+    if (data[1] != BMS_FRAME_VERSION) {
+        consumed = 1;
+        return DecodeResult::BAD_VERSION;
+    }
+
+    uint16_t present = data[3] | (data[4] << 8);
+    size_t frameLength = encodedSize(present);
+    if (length < frameLength) {
+        return DecodeResult::INCOMPLETE;
+    }
+
+    size_t crcOffset = frameLength - BMS_FRAME_CRC_SIZE;
+    uint16_t crc = data[crcOffset] | (data[crcOffset + 1] << 8);
+    if (crc != crc16(data + 1, crcOffset - 1)) {
+        consumed = 1;
+        return DecodeResult::BAD_CRC;
+    }
+
+    memset(&record, 0, sizeof(record));
+    record.present = present;
+    sequence = data[2];
+
+    const uint8_t* p = data + BMS_FRAME_HEADER_SIZE;
+    if (present & mask(TIMESTAMP))             record.timestamp = getU32(p);
+    if (present & mask(VOLTAGE))               record.voltage = getU16(p);
+    if (present & mask(CURRENT))               record.current = getU16(p);
+    if (present & mask(AVERAGE_CURRENT))       record.averageCurrent = getU16(p);
+    if (present & mask(TEMPERATURE))           record.temperature = getU16(p);
+    if (present & mask(STATE_OF_CHARGE))       record.stateOfCharge = *p++;
+    if (present & mask(STATE_OF_HEALTH))       record.stateOfHealth = *p++;
+    if (present & mask(REMAINING_CAPACITY))    record.remainingCapacity = getU16(p);
+    if (present & mask(FULL_CAPACITY))         record.fullCapacity = getU16(p);
+    if (present & mask(FLAGS))                 record.flags = getU16(p);
+    if (present & mask(CONTROL))               record.control = getU16(p);
+    if (present & mask(MAX_TEMP))              record.maxTemp = getU16(p);
+    if (present & mask(MIN_TEMP))              record.minTemp = getU16(p);
+    if (present & mask(MAX_CHARGE_CURRENT))    record.maxChargeCurrent = getU16(p);
+    if (present & mask(MAX_DISCHARGE_CURRENT)) record.maxDischargeCurrent = getU16(p);
+    if (present & mask(PACK_VOLTAGE_RANGE)) {
+        record.maxPackVoltage = getU16(p);
+        record.minPackVoltage = getU16(p);
+    }
+
+    consumed = frameLength;
+    return DecodeResult::OK;
+}
+
+uint16_t BMSFrame::crc16(const uint8_t* data, size_t length, uint16_t crc) {
+    // CRC-16/CCITT-FALSE, polynomial 0x1021, bitwise to avoid a 512-byte table
+    while (length--) {
+        crc ^= (uint16_t)*data++ << 8;
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+uint8_t BMSFrame::fieldSize(uint8_t field) {
+    switch (field) {
+        case TIMESTAMP:
+        case PACK_VOLTAGE_RANGE:
+            return 4;
+        case STATE_OF_CHARGE:
+        case STATE_OF_HEALTH:
+            return 1;
+        default:
+            return 2;
+    }
+}
+
+#ifdef ARDUINO
+void BMSFrame::fromSnapshot(const BMSLib::StatusSnapshot& snapshot, Record& record) {
+    // Raw readings, so a receiver sees an out-of-range value rather than a 0
+    record.voltage = snapshot.rawVoltage;
+    record.current = snapshot.rawCurrent;
+    record.averageCurrent = snapshot.averageCurrent;
+    record.temperature = snapshot.rawTemperature;
+    record.stateOfCharge = snapshot.stateOfCharge;
+    record.remainingCapacity = snapshot.remainingCapacity;
+    record.fullCapacity = snapshot.fullCapacity;
+    record.flags = snapshot.flags;
+    record.control = snapshot.control;
+    record.present |= mask(VOLTAGE) | mask(CURRENT) | mask(AVERAGE_CURRENT) |
+                      mask(TEMPERATURE) | mask(STATE_OF_CHARGE) | mask(REMAINING_CAPACITY) |
+                      mask(FULL_CAPACITY) | mask(FLAGS) | mask(CONTROL);
+}
+
+void BMSFrame::fromLifetimeStats(const BMSLib::LifetimeStats& stats, Record& record) {
+    record.maxTemp = stats.maxTemp;
+    record.minTemp = stats.minTemp;
+    record.maxChargeCurrent = stats.maxChargeCurrent;
+    record.maxDischargeCurrent = stats.maxDischargeCurrent;
+    record.maxPackVoltage = stats.maxPackVoltage;
+    record.minPackVoltage = stats.minPackVoltage;
+    record.present |= mask(MAX_TEMP) | mask(MIN_TEMP) | mask(MAX_CHARGE_CURRENT) |
+                      mask(MAX_DISCHARGE_CURRENT) | mask(PACK_VOLTAGE_RANGE);
+}
+#endif
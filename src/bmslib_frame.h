@@ -0,0 +1,102 @@
+#ifndef BMSLIB_FRAME_H
+#define BMSLIB_FRAME_H
+
+// Packed binary telemetry frames. This header and bmslib_frame.cpp build without
+// Arduino so the same decoder can run on a host; the BMSLib conversions are only
+// compiled for Arduino targets.
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef ARDUINO
+#include "BMSLib.h"
+#endif
+
+#define BMS_FRAME_SYNC          0xB5
+#define BMS_FRAME_VERSION       1
+#define BMS_FRAME_HEADER_SIZE   5       // Sync, version, sequence, presence bitmap
+#define BMS_FRAME_CRC_SIZE      2
+#define BMS_FRAME_MAX_PAYLOAD   34
+#define BMS_FRAME_MAX_SIZE      (BMS_FRAME_HEADER_SIZE + BMS_FRAME_MAX_PAYLOAD + BMS_FRAME_CRC_SIZE)
+
+// Frame layout, little-endian:
+//   0xB5 | version | sequence | presence (2) | fields in bit order | CRC-16 (2)
+// The CRC is CRC-16/CCITT-FALSE over everything after the sync byte.
+class BMSFrame {
+public:
+    // Presence bits, in payload order
+    enum Field : uint8_t {
+        TIMESTAMP,              // uint32_t ms
+        VOLTAGE,                // uint16_t mV
+        CURRENT,                // int16_t mA
+        AVERAGE_CURRENT,        // int16_t mA
+        TEMPERATURE,            // uint16_t 0.1K
+        STATE_OF_CHARGE,        // uint8_t %
+        STATE_OF_HEALTH,        // uint8_t %
+        REMAINING_CAPACITY,     // uint16_t mAh
+        FULL_CAPACITY,          // uint16_t mAh
+        FLAGS,                  // uint16_t FLAGS register
+        CONTROL,                // uint16_t control status
+        MAX_TEMP,               // uint16_t 0.1K, lifetime
+        MIN_TEMP,               // uint16_t 0.1K, lifetime
+        MAX_CHARGE_CURRENT,     // int16_t mA, lifetime
+        MAX_DISCHARGE_CURRENT,  // int16_t mA, lifetime
+        PACK_VOLTAGE_RANGE,     // uint16_t max, uint16_t min mV, lifetime
+        FIELD_COUNT
+    };
+
+    enum class DecodeResult : uint8_t {
+        OK,
+        INCOMPLETE,             // Need more bytes; nothing consumed
+        BAD_SYNC,               // Skipped to the next sync byte
+        BAD_VERSION,
+        BAD_CRC
+    };
+
+    struct Record {
+        uint16_t present;       // Bitmask of fields below that are valid
+        uint32_t timestamp;
+        uint16_t voltage;
+        int16_t current;
+        int16_t averageCurrent;
+        uint16_t temperature;
+        uint8_t stateOfCharge;
+        uint8_t stateOfHealth;
+        uint16_t remainingCapacity;
+        uint16_t fullCapacity;
+        uint16_t flags;
+        uint16_t control;
+        uint16_t maxTemp;
+        uint16_t minTemp;
+        int16_t maxChargeCurrent;
+        int16_t maxDischargeCurrent;
+        uint16_t maxPackVoltage;
+        uint16_t minPackVoltage;
+    };
+
+    static constexpr uint16_t mask(Field field) {
+        return static_cast<uint16_t>(1u << field);
+    }
+
+    static size_t encodedSize(uint16_t present);
+
+    // Write a frame straight into out; returns its length, or 0 if size is too small
+    static size_t encode(const Record& record, uint8_t sequence, uint8_t* out, size_t size);
+
+    // Parse one frame from the start of data. consumed tells the caller how many bytes
+    // to discard: the frame on OK, garbage up to the next sync byte on errors.
+    static DecodeResult decode(const uint8_t* data, size_t length, Record& record,
+                               uint8_t& sequence, size_t& consumed);
+
+    static uint16_t crc16(const uint8_t* data, size_t length, uint16_t crc = 0xFFFF);
+
+#ifdef ARDUINO
+    // Fill a record from library structures; each call sets its fields' presence bits
+    static void fromSnapshot(const BMSLib::StatusSnapshot& snapshot, Record& record);
+    static void fromLifetimeStats(const BMSLib::LifetimeStats& stats, Record& record);
+#endif
+
+private:
+    static uint8_t fieldSize(uint8_t field);
+};
+
+#endif // BMSLIB_FRAME_H
@@ -0,0 +1,302 @@
+#include "BMSLib.h"
+
+// Golden image provisioning. The image is a flat list of records, usually a const
+// array built with BMS_IMAGE_DF()/BMS_IMAGE_REG() or loaded from a file:
+//   subclass, offset, length, bytes[length]
+// Every data flash block the records touch is read once, the records are overlaid on
+// a copy, and only a block that differs is committed: the changed byte range plus the
+// checksum, which the gauge verifies when the block is read back. Registers are
+// compared the same way and written only when they differ.
+
+#define BMS_IMAGE_HEADER        3
+#define BMS_IMAGE_MAX_REGISTER  2       // Standard commands are words
+
+#define BMS_FNV_OFFSET          2166136261UL
+#define BMS_FNV_PRIME           16777619UL
+
+static_assert(BMS_FINGERPRINT_SECTIONS >= 1 && BMS_FINGERPRINT_SECTIONS <= 32,
+              "fingerprint sections must fit the 32-bit difference mask");
+
+bool BMSLib::applyImage(const uint8_t* image, uint16_t length, ImageResult& result) {
+    return processImage(image, length, true, result);
+}
+
+bool BMSLib::compareImage(const uint8_t* image, uint16_t length, ImageResult& result) {
+    return processImage(image, length, false, result) &&
+           result.blocksChanged == 0 && result.registersChanged == 0;
+}
+
+bool BMSLib::processImage(const uint8_t* image, uint16_t length, bool write, ImageResult& result) {
+    uint32_t start = millis();
+    memset(&result, 0, sizeof(result));
+
+    if (!imageValid(image, length)) {
+        finishTransfer(Status::INVALID_ARGUMENT);
+        return false;
+    }
+    if (!beginConfig()) {
+        result.elapsedMs = millis() - start;
+        return false;
+    }
+
+    bool success = true;
+    for (uint16_t position = 0; success && position < length;
+         position += BMS_IMAGE_HEADER + image[position + 2]) {
+        const uint8_t* record = image + position;
+        if (record[0] == BMS_IMAGE_REGISTER) {
+            success = imageRegister(record, write, result);
+            continue;
+        }
+
+        uint8_t first = record[1] / BMS_DATAFLASH_BLOCK_SIZE;
+        uint8_t last = (record[1] + record[2] - 1) / BMS_DATAFLASH_BLOCK_SIZE;
+        for (uint8_t block = first; success && block <= last; block++) {
+            // A block already handled for an earlier record is complete
+            bool seen = false;
+            for (uint16_t earlier = 0; earlier < position && !seen;
+                 earlier += BMS_IMAGE_HEADER + image[earlier + 2]) {
+                const uint8_t* other = image + earlier;
+                seen = other[0] == record[0] &&
+                       other[1] / BMS_DATAFLASH_BLOCK_SIZE <= block &&
+                       (other[1] + other[2] - 1) / BMS_DATAFLASH_BLOCK_SIZE >= block;
+            }
+            if (!seen) {
+                success = imageBlock(image, length, record[0], block, write, result);
+            }
+        }
+    }
+
+    success = endConfig(success);
+    result.elapsedMs = millis() - start;
+    return success;
+}
+
+bool BMSLib::imageBlock(const uint8_t* image, uint16_t length, uint8_t subclass, uint8_t block,
+                        bool write, ImageResult& result) {
+    uint8_t current[BMS_DATAFLASH_BLOCK_SIZE];
+    if (!readDataFlashBlock(subclass, block, current)) {
+        return false;
+    }
+    result.blocksChecked++;
+
+    // Overlay every record of this subclass that reaches into the block
+    uint8_t target[BMS_DATAFLASH_BLOCK_SIZE];
+    memcpy(target, current, sizeof(target));
+    const uint16_t blockStart = block * BMS_DATAFLASH_BLOCK_SIZE;
+    for (uint16_t position = 0; position < length;
+         position += BMS_IMAGE_HEADER + image[position + 2]) {
+        const uint8_t* record = image + position;
+        if (record[0] != subclass) {
+            continue;
+        }
+        uint16_t from = record[1] > blockStart ? record[1] : blockStart;
+        uint16_t to = record[1] + record[2];
+        if (to > blockStart + BMS_DATAFLASH_BLOCK_SIZE) to = blockStart + BMS_DATAFLASH_BLOCK_SIZE;
+        for (uint16_t i = from; i < to; i++) {
+            target[i - blockStart] = record[BMS_IMAGE_HEADER + i - record[1]];
+        }
+    }
+
+    uint8_t from = BMS_DATAFLASH_BLOCK_SIZE;
+    uint8_t to = 0;
+    for (uint8_t i = 0; i < BMS_DATAFLASH_BLOCK_SIZE; i++) {
+        if (target[i] != current[i]) {
+            if (from > i) from = i;
+            to = i + 1;
+        }
+    }
+    if (from >= to) {
+        return true;
+    }
+
+    result.blocksChanged++;
+    if (!write) {
+        return true;
+    }
+
+    // readDataFlashBlock() left the block selected; the commit verifies the checksum
+    if (!commitDataFlash(target, from, to)) {
+        return false;
+    }
+    result.bytesWritten += to - from;
+    shadowUpdate(subclass, block, target);
+    return true;
+}
+
+bool BMSLib::imageRegister(const uint8_t* record, bool write, ImageResult& result) {
+    const uint8_t command = record[1];
+    const uint8_t size = record[2];
+    const uint8_t* value = record + BMS_IMAGE_HEADER;
+
+    uint8_t current[BMS_IMAGE_MAX_REGISTER];
+    if (!readBlock(command, current, size)) {
+        return false;
+    }
+    if (memcmp(current, value, size) == 0) {
+        return true;
+    }
+
+    result.registersChanged++;
+    if (!write) {
+        return true;
+    }
+    if (!writeBlock(command, value, size) || !readBlock(command, current, size)) {
+        return false;
+    }
+    result.bytesWritten += size;
+    return memcmp(current, value, size) == 0;
+}
+
+bool BMSLib::imageValid(const uint8_t* image, uint16_t length) {
+    if (image == nullptr || length == 0) {
+        return false;
+    }
+
+    uint16_t position = 0;
+    while (position < length) {
+        if (length - position < BMS_IMAGE_HEADER) {
+            return false;
+        }
+        const uint8_t* record = image + position;
+        uint8_t size = record[2];
+        if (size == 0 || length - position - BMS_IMAGE_HEADER < size) {
+            return false;
+        }
+        // Subclass offsets are 8-bit, so a record cannot run past offset 255
+        if (record[0] == BMS_IMAGE_REGISTER ? size > BMS_IMAGE_MAX_REGISTER
+                                            : record[1] + size > 0x100) {
+            return false;
+        }
+        position += BMS_IMAGE_HEADER + size;
+    }
+    return true;
+}
+
+// Fingerprints let a warm boot check the whole image with reads only. Each record is
+// hashed with its header, so the image layout is part of the fingerprint too.
+
+bool BMSLib::begin(const uint8_t* image, uint16_t length, uint32_t* differing) {
+    if (differing != nullptr) {
+        *differing = 0;
+    }
+
+    Fingerprint desired;
+    Fingerprint actual;
+    if (!begin() || !imageFingerprint(image, length, desired) ||
+        !readFingerprint(image, length, actual)) {
+        return false;
+    }
+
+    uint32_t mask = compareFingerprints(desired, actual);
+    if (differing != nullptr) {
+        *differing = mask;
+    }
+    if (mask == 0) {
+        return true;  // Already provisioned: no config writes at all
+    }
+
+    ImageResult result;
+    return applyImage(image, length, result);
+}
+
+bool BMSLib::imageFingerprint(const uint8_t* image, uint16_t length, Fingerprint& fingerprint) {
+    memset(&fingerprint, 0, sizeof(fingerprint));
+    if (!imageValid(image, length)) {
+        return false;
+    }
+
+    uint32_t hash = BMS_FNV_OFFSET;
+    uint32_t section = BMS_FNV_OFFSET;
+    uint16_t record = 0;
+    for (uint16_t position = 0; position < length;
+         position += BMS_IMAGE_HEADER + image[position + 2], record++) {
+        const uint16_t size = BMS_IMAGE_HEADER + image[position + 2];
+        if (record < BMS_FINGERPRINT_SECTIONS) {
+            section = BMS_FNV_OFFSET;
+        }
+        hash = fingerprintHash(hash, image + position, size);
+        section = fingerprintHash(section, image + position, size);
+        fingerprintSection(fingerprint, record, section);
+    }
+    fingerprint.hash = hash;
+    return true;
+}
+
+bool BMSLib::readFingerprint(const uint8_t* image, uint16_t length, Fingerprint& fingerprint) {
+    memset(&fingerprint, 0, sizeof(fingerprint));
+    if (!imageValid(image, length)) {
+        finishTransfer(Status::INVALID_ARGUMENT);
+        return false;
+    }
+
+    // Data flash is only readable in config mode; registers are read without it
+    bool flash = false;
+    for (uint16_t position = 0; position < length && !flash;
+         position += BMS_IMAGE_HEADER + image[position + 2]) {
+        flash = image[position] != BMS_IMAGE_REGISTER;
+    }
+    if (flash && !beginConfig()) {
+        return false;
+    }
+
+    bool success = true;
+    uint32_t hash = BMS_FNV_OFFSET;
+    uint32_t section = BMS_FNV_OFFSET;
+    uint16_t record = 0;
+    for (uint16_t position = 0; success && position < length;
+         position += BMS_IMAGE_HEADER + image[position + 2], record++) {
+        const uint8_t* header = image + position;
+        if (record < BMS_FINGERPRINT_SECTIONS) {
+            section = BMS_FNV_OFFSET;
+        }
+        hash = fingerprintHash(hash, header, BMS_IMAGE_HEADER);
+        section = fingerprintHash(section, header, BMS_IMAGE_HEADER);
+
+        uint8_t data[BMS_DATAFLASH_BLOCK_SIZE];
+        uint8_t offset = header[1];
+        uint8_t remaining = header[2];
+        while (success && remaining > 0) {
+            uint8_t chunk = remaining > sizeof(data) ? sizeof(data) : remaining;
+            success = header[0] == BMS_IMAGE_REGISTER ? readBlock(header[1], data, chunk)
+                                                      : readShadow(header[0], offset, data, chunk);
+            hash = fingerprintHash(hash, data, chunk);
+            section = fingerprintHash(section, data, chunk);
+            offset += chunk;
+            remaining -= chunk;
+        }
+        fingerprintSection(fingerprint, record, section);
+    }
+    fingerprint.hash = hash;
+
+    return flash ? endConfig(success) : success;
+}
+
+uint32_t BMSLib::compareFingerprints(const Fingerprint& a, const Fingerprint& b) {
+    uint8_t count = a.count > b.count ? a.count : b.count;
+    uint32_t mask = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        if (a.sections[i] != b.sections[i]) {
+            mask |= 1UL << i;
+        }
+    }
+
+    // Section hashes are 16-bit; a collision still shows in the full hash
+    if (mask == 0 && a.hash != b.hash) {
+        mask = count >= 32 ? 0xFFFFFFFFUL : (1UL << count) - 1;
+    }
+    return mask;
+}
+
+uint32_t BMSLib::fingerprintHash(uint32_t hash, const uint8_t* data, uint16_t length) {
+    for (uint16_t i = 0; i < length; i++) {
+        hash ^= data[i];
+        hash *= BMS_FNV_PRIME;
+    }
+    return hash;
+}
+
+void BMSLib::fingerprintSection(Fingerprint& fingerprint, uint16_t record, uint32_t hash) {
+    uint8_t slot = record < BMS_FINGERPRINT_SECTIONS ? record : BMS_FINGERPRINT_SECTIONS - 1;
+    fingerprint.sections[slot] = static_cast<uint16_t>(hash ^ (hash >> 16));
+    fingerprint.count = slot + 1;
+}
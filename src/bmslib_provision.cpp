@@ -0,0 +1,250 @@
+#include "bmslib_provision.h"
+
+BMSProvisioner::BMSProvisioner() :
+    _unitCount(0),
+    _remaining(0),
+    _startMs(0),
+    _elapsedMs(0) {
+}
+
+int8_t BMSProvisioner::addUnit(BMSLib& gauge, const Plan& plan) {
+    if (_unitCount >= BMS_PROVISION_MAX_UNITS || _remaining > 0) {
+        return -1;
+    }
+
+    Unit& unit = _units[_unitCount];
+    unit.gauge = &gauge;
+    unit.bus = nullptr;
+    unit.busIndex = 0;
+    unit.plan = &plan;
+    unit.op = 0;
+    unit.failed = false;
+    unit.result.stage = Stage::QUEUED;
+    unit.result.failedStage = Stage::DONE;
+    unit.result.elapsedMs = 0;
+    memset(&unit.result.image, 0, sizeof(unit.result.image));
+    return _unitCount++;
+}
+
+int8_t BMSProvisioner::addUnit(BMSBusManager& bus, uint8_t gauge, const Plan& plan) {
+    BMSLib* target = bus.select(gauge);
+    if (target == nullptr) {
+        return -1;
+    }
+
+    int8_t index = addUnit(*target, plan);
+    if (index >= 0) {
+        _units[index].bus = &bus;
+        _units[index].busIndex = gauge;
+    }
+    return index;
+}
+
+void BMSProvisioner::clear() {
+    if (_remaining == 0) {
+        _unitCount = 0;
+    }
+}
+
+bool BMSProvisioner::start() {
+    if (_remaining > 0 || _unitCount == 0) {
+        return false;
+    }
+
+    for (uint8_t i = 0; i < _unitCount; i++) {
+        Unit& unit = _units[i];
+        unit.op = 0;
+        unit.failed = false;
+        unit.result.stage = Stage::QUEUED;
+        unit.result.failedStage = Stage::DONE;
+        unit.result.elapsedMs = 0;
+        memset(&unit.result.image, 0, sizeof(unit.result.image));
+    }
+
+    _remaining = _unitCount;
+    _startMs = millis();
+    _elapsedMs = 0;
+    return true;
+}
+
+bool BMSProvisioner::poll() {
+    for (uint8_t i = 0; i < _unitCount && _remaining > 0; i++) {
+        Unit& unit = _units[i];
+        if (unit.result.stage == Stage::DONE) {
+            continue;
+        }
+        if (service(unit) && unit.result.stage == Stage::DONE) {
+            unit.result.elapsedMs = millis() - _startMs;
+            if (--_remaining == 0) {
+                _elapsedMs = unit.result.elapsedMs;
+            }
+        }
+    }
+    return _remaining > 0;
+}
+
+bool BMSProvisioner::run() {
+    if (!start()) {
+        return false;
+    }
+    while (poll()) {
+        yield();
+    }
+    return getFailedCount() == 0;
+}
+
+bool BMSProvisioner::isRunning() const {
+    return _remaining > 0;
+}
+
+uint8_t BMSProvisioner::getUnitCount() const {
+    return _unitCount;
+}
+
+const BMSProvisioner::UnitResult& BMSProvisioner::getResult(uint8_t unit) const {
+    return _units[unit < _unitCount ? unit : 0].result;
+}
+
+uint8_t BMSProvisioner::getFailedCount() const {
+    uint8_t failed = 0;
+    for (uint8_t i = 0; i < _unitCount; i++) {
+        if (_units[i].failed) {
+            failed++;
+        }
+    }
+    return failed;
+}
+
+uint32_t BMSProvisioner::getElapsedMs() const {
+    return _remaining > 0 ? millis() - _startMs : _elapsedMs;
+}
+
+bool BMSProvisioner::service(Unit& unit) {
+    // Route the mux first; a pending operation may write to the gauge when polled
+    if (unit.bus != nullptr && unit.bus->select(unit.busIndex) == nullptr) {
+        if (unit.op != 0) {
+            return false;  // Retry on the next pass rather than abandon the operation
+        }
+        fail(unit);
+        return true;
+    }
+
+    if (unit.op != 0) {
+        BMSLib::OpState state = unit.gauge->poll();
+        if (state == BMSLib::OpState::PENDING) {
+            return false;
+        }
+        unit.op = 0;
+        if (state != BMSLib::OpState::DONE) {
+            fail(unit);
+            return true;
+        }
+        advance(unit);
+    } else if (unit.result.stage == Stage::QUEUED) {
+        advance(unit);
+    }
+
+    // Run stages that need no settling until one starts a mode switch
+    while (unit.result.stage != Stage::DONE && unit.op == 0) {
+        if (!runStage(unit)) {
+            fail(unit);
+            return true;
+        }
+        if (unit.op == 0) {
+            advance(unit);
+        }
+    }
+    return true;
+}
+
+bool BMSProvisioner::runStage(Unit& unit) {
+    BMSLib& gauge = *unit.gauge;
+    const Plan& plan = *unit.plan;
+
+    switch (unit.result.stage) {
+        case Stage::FACTORY_RESET:
+            unit.op = gauge.factoryResetAsync();
+            return unit.op != 0;
+
+        case Stage::ENTER_CONFIG:
+            unit.op = gauge.enterConfigModeAsync();
+            return unit.op != 0;
+
+        case Stage::CHEMISTRY:
+            unit.op = gauge.setBatteryChemistryAsync(plan.chemistry);
+            return unit.op != 0;
+
+        case Stage::IMAGE:
+            return gauge.applyImage(plan.image, plan.imageLength, unit.result.image);
+
+        case Stage::CAPACITY:
+            return gauge.setCapacityConfig(*plan.capacity);
+
+        case Stage::POWER_SAVING:
+            return gauge.configurePowerSaving(*plan.power);
+
+        case Stage::CALIBRATION:
+            return gauge.performFullCalibration(*plan.voltageCal, *plan.currentCal, *plan.tempCal);
+
+        case Stage::EXIT_CONFIG:
+            unit.op = gauge.exitConfigModeAsync();
+            return unit.op != 0;
+
+        default:
+            return true;
+    }
+}
+
+void BMSProvisioner::advance(Unit& unit) {
+    if (unit.failed) {
+        // Only leaving config mode remains after a failure
+        unit.result.stage = Stage::DONE;
+        return;
+    }
+
+    Stage next = unit.result.stage;
+    do {
+        next = static_cast<Stage>(static_cast<uint8_t>(next) + 1);
+    } while (next != Stage::DONE && isSkipped(unit, next));
+    unit.result.stage = next;
+}
+
+void BMSProvisioner::fail(Unit& unit) {
+    if (!unit.failed) {
+        unit.failed = true;
+        unit.result.failedStage = unit.result.stage;
+    }
+
+    // Leave the gauge out of config mode; the exit is interleaved like any other switch
+    if (unit.result.stage != Stage::EXIT_CONFIG && unit.result.stage != Stage::DONE) {
+        unit.result.stage = Stage::EXIT_CONFIG;
+        unit.op = unit.gauge->exitConfigModeAsync();
+        if (unit.op != 0) {
+            return;
+        }
+    }
+    unit.op = 0;
+    unit.result.stage = Stage::DONE;
+}
+
+bool BMSProvisioner::isSkipped(const Unit& unit, Stage stage) const {
+    const Plan& plan = *unit.plan;
+
+    switch (stage) {
+        case Stage::FACTORY_RESET:
+            return !plan.factoryReset;
+        case Stage::CHEMISTRY:
+            return !plan.setChemistry;
+        case Stage::IMAGE:
+            return plan.image == nullptr;
+        case Stage::CAPACITY:
+            return plan.capacity == nullptr;
+        case Stage::POWER_SAVING:
+            return plan.power == nullptr;
+        case Stage::CALIBRATION:
+            return plan.voltageCal == nullptr || plan.currentCal == nullptr ||
+                   plan.tempCal == nullptr;
+        default:
+            return false;
+    }
+}
@@ -0,0 +1,92 @@
+#ifndef BMSLIB_PROVISION_H
+#define BMSLIB_PROVISION_H
+
+#include "BMSLib.h"
+#include "bmslib_bus.h"
+
+#ifndef BMS_PROVISION_MAX_UNITS
+#define BMS_PROVISION_MAX_UNITS 16
+#endif
+
+// Provisions a batch of gauges at once. Every mode switch is a non-blocking operation,
+// so while one unit settles after a reset or config-mode change the next unit is
+// already being driven. Total time approaches the longest single-unit chain instead
+// of the sum over all units.
+class BMSProvisioner {
+public:
+    // What to apply to a unit; null pointers skip that step
+    struct Plan {
+        bool factoryReset;
+        bool setChemistry;
+        BMSLib::BatteryChemistry chemistry;
+        const BMSLib::CapacityConfig* capacity;
+        const BMSLib::PowerConfig* power;
+        const BMSLib::VoltageCalibration* voltageCal;  // Calibration runs only when all
+        const BMSLib::CurrentCalibration* currentCal;  // three references are provided
+        const BMSLib::TempCalibration* tempCal;
+        const uint8_t* image;       // Golden image (see applyImage()), written as a diff
+        uint16_t imageLength;
+    };
+
+    enum class Stage : uint8_t {
+        QUEUED,
+        FACTORY_RESET,
+        ENTER_CONFIG,
+        CHEMISTRY,
+        IMAGE,
+        CAPACITY,
+        POWER_SAVING,
+        CALIBRATION,
+        EXIT_CONFIG,
+        DONE
+    };
+
+    struct UnitResult {
+        Stage stage;            // Current stage, DONE once finished
+        Stage failedStage;      // First stage that failed, DONE if none did
+        uint32_t elapsedMs;     // Time from start() to completion
+        BMSLib::ImageResult image;  // Blocks compared and written, and the image time
+    };
+
+    BMSProvisioner();
+
+    // Units are referenced, not copied; plans must outlive the run
+    int8_t addUnit(BMSLib& gauge, const Plan& plan);
+    int8_t addUnit(BMSBusManager& bus, uint8_t gauge, const Plan& plan);
+    void clear();
+
+    bool start();
+    bool poll();            // Advance every unit once; false when the batch is finished
+    bool run();             // Block until finished; true if every unit succeeded
+    bool isRunning() const;
+
+    uint8_t getUnitCount() const;
+    const UnitResult& getResult(uint8_t unit) const;
+    uint8_t getFailedCount() const;
+    uint32_t getElapsedMs() const;
+
+private:
+    struct Unit {
+        BMSLib* gauge;
+        BMSBusManager* bus;     // Routes mux channels before each access, may be null
+        uint8_t busIndex;
+        const Plan* plan;
+        BMSLib::OpHandle op;    // Pending mode switch, 0 when none
+        bool failed;
+        UnitResult result;
+    };
+
+    Unit _units[BMS_PROVISION_MAX_UNITS];
+    uint8_t _unitCount;
+    uint8_t _remaining;
+    uint32_t _startMs;
+    uint32_t _elapsedMs;
+
+    bool service(Unit& unit);
+    bool runStage(Unit& unit);
+    void advance(Unit& unit);
+    void fail(Unit& unit);
+    bool isSkipped(const Unit& unit, Stage stage) const;
+};
+
+#endif // BMSLIB_PROVISION_H
@@ -0,0 +1,113 @@
+#include "bmslib_publish.h"
+
+// Seqlock: the writer makes the sequence odd, copies the snapshot, then makes it even
+// again. A reader copies between two loads of the sequence and keeps the copy only if
+// both loads match and are even. The GCC __atomic builtins give the ordering on every
+// target this library builds for (AVR, Xtensa, RISC-V, ARM, x86).
+
+BMSSnapshotPublisher::BMSSnapshotPublisher(BMSLib& gauge) :
+    _gauge(gauge),
+    _attached(false),
+    _intervalMs(1000),
+    _lastSample(0),
+    _sampled(false),
+    _publishCount(0),
+    _sequence(0),
+    _timestamp(0) {
+    memset(&_snapshot, 0, sizeof(_snapshot));
+}
+
+BMSSnapshotPublisher::~BMSSnapshotPublisher() {
+    end();
+}
+
+bool BMSSnapshotPublisher::begin() {
+    if (_attached) {
+        return true;
+    }
+    _attached = _gauge.addSnapshotListener(onSnapshot, this);
+    return _attached;
+}
+
+void BMSSnapshotPublisher::end() {
+    if (_attached) {
+        _gauge.removeSnapshotListener(onSnapshot, this);
+        _attached = false;
+    }
+}
+
+void BMSSnapshotPublisher::setInterval(uint32_t intervalMs) {
+    _intervalMs = intervalMs;
+}
+
+bool BMSSnapshotPublisher::poll() {
+    // The interval runs from the last attempt, so a failing gauge is not read every call
+    if (_sampled && millis() - _lastSample < _intervalMs) {
+        return false;
+    }
+    return sample();
+}
+
+bool BMSSnapshotPublisher::sample() {
+    BMSLib::StatusSnapshot snapshot;
+    _lastSample = millis();
+    _sampled = true;
+    if (!_gauge.readStatusSnapshot(snapshot)) {
+        return false;
+    }
+    // Attached publishers already got it through the listener
+    if (!_attached) {
+        publish(snapshot);
+    }
+    return true;
+}
+
+bool BMSSnapshotPublisher::read(BMSLib::StatusSnapshot& snapshot, uint32_t* timestampMs) const {
+    for (uint8_t attempt = 0; attempt < BMS_PUBLISH_READ_ATTEMPTS; attempt++) {
+        Sequence before = __atomic_load_n(&_sequence, __ATOMIC_ACQUIRE);
+        if (before == 0) {
+            return false;  // Nothing published yet
+        }
+        if (before & 1) {
+            continue;
+        }
+
+        memcpy(&snapshot, &_snapshot, sizeof(snapshot));
+        uint32_t timestamp = _timestamp;
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&_sequence, __ATOMIC_RELAXED) == before) {
+            if (timestampMs != nullptr) {
+                *timestampMs = timestamp;
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+uint32_t BMSSnapshotPublisher::getPublishCount() const {
+    return _publishCount;
+}
+
+void BMSSnapshotPublisher::publish(const BMSLib::StatusSnapshot& snapshot) {
+    Sequence sequence = _sequence;
+
+    // Skip 0 on wrap so readers never mistake a live slot for an empty one
+    __atomic_store_n(&_sequence, static_cast<Sequence>(sequence + 1), __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    memcpy(&_snapshot, &snapshot, sizeof(_snapshot));
+    _timestamp = millis();
+
+    sequence += 2;
+    if (sequence == 0) {
+        sequence = 2;
+    }
+    __atomic_store_n(&_sequence, sequence, __ATOMIC_RELEASE);
+    _publishCount++;
+}
+
+void BMSSnapshotPublisher::onSnapshot(const BMSLib::StatusSnapshot& snapshot, void* context) {
+    static_cast<BMSSnapshotPublisher*>(context)->publish(snapshot);
+}
@@ -0,0 +1,55 @@
+#ifndef BMSLIB_PUBLISH_H
+#define BMSLIB_PUBLISH_H
+
+#include "BMSLib.h"
+
+// Attempts read() makes before giving up on a writer that keeps the slot busy
+#ifndef BMS_PUBLISH_READ_ATTEMPTS
+#define BMS_PUBLISH_READ_ATTEMPTS   16
+#endif
+
+// Single-owner sampling with lock-free readers. One task owns the gauge and the bus;
+// every status snapshot it reads is published through a seqlock. Any other task (or an
+// ISR) gets the latest consistent snapshot with read(), without touching I2C and without
+// ever blocking the owner. Only the owning task may call into the BMSLib instance.
+class BMSSnapshotPublisher {
+public:
+    explicit BMSSnapshotPublisher(BMSLib& gauge);
+    ~BMSSnapshotPublisher();
+
+    // Owner task: publish every snapshot the gauge reads, whoever requested it
+    bool begin();
+    void end();
+
+    // Owner task: read a snapshot every intervalMs; true when one was published
+    void setInterval(uint32_t intervalMs);
+    bool poll();
+    bool sample();
+
+    // Any task: copy the latest snapshot. False until the first publication, or if
+    // the writer was mid-update on every attempt (e.g. a reader ISR preempting it)
+    bool read(BMSLib::StatusSnapshot& snapshot, uint32_t* timestampMs = nullptr) const;
+    uint32_t getPublishCount() const;
+
+private:
+#if defined(__AVR__)
+    typedef uint8_t Sequence;   // Single-byte loads are atomic on AVR
+#else
+    typedef uint32_t Sequence;
+#endif
+
+    BMSLib& _gauge;
+    bool _attached;
+    uint32_t _intervalMs;
+    uint32_t _lastSample;
+    bool _sampled;              // A read has been attempted; _lastSample is valid
+    uint32_t _publishCount;     // Written by the owner only
+    Sequence _sequence;         // Odd while the slot is being written
+    BMSLib::StatusSnapshot _snapshot;
+    uint32_t _timestamp;
+
+    void publish(const BMSLib::StatusSnapshot& snapshot);
+    static void onSnapshot(const BMSLib::StatusSnapshot& snapshot, void* context);
+};
+
+#endif // BMSLIB_PUBLISH_H
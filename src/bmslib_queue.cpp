@@ -0,0 +1,196 @@
+#include "bmslib_queue.h"
+
+namespace {
+
+// Snapshot reads larger than the Wire buffer are split like readStatusSnapshot() does
+const uint8_t SNAPSHOT_CHUNK = BMS_WIRE_BUFFER_SIZE & ~1;
+
+}  // namespace
+
+BMSTransferQueue::BMSTransferQueue(BMSLib& gauge) :
+    _gauge(gauge),
+    _head(0),
+    _count(0),
+    _inFlight(false) {
+    resetStats();
+}
+
+bool BMSTransferQueue::submitRead(uint8_t command, uint8_t* data, uint8_t length,
+                                  ReadCallback callback, void* context) {
+    Transfer* transfer = push(Kind::READ, command, length, context);
+    if (transfer == nullptr) {
+        return false;
+    }
+    transfer->target.data = data;
+    transfer->callback.read = callback;
+    return true;
+}
+
+bool BMSTransferQueue::submitField(BMSLib::Field field, FieldCallback callback, void* context) {
+    // Single-byte fields read the word too; decodeField() keeps only the low byte
+    Transfer* transfer = push(Kind::FIELD, BMSLib::fieldRegister(field), 2, context);
+    if (transfer == nullptr) {
+        return false;
+    }
+    transfer->field = static_cast<uint8_t>(field);
+    transfer->callback.field = callback;
+    return true;
+}
+
+bool BMSTransferQueue::submitSnapshot(BMSLib::StatusSnapshot& snapshot, SnapshotCallback callback,
+                                      void* context) {
+    Transfer* transfer = push(Kind::SNAPSHOT, BMS_SNAPSHOT_START, BMS_SNAPSHOT_LENGTH, context);
+    if (transfer == nullptr) {
+        return false;
+    }
+    transfer->target.snapshot = &snapshot;
+    transfer->callback.snapshot = callback;
+    return true;
+}
+
+uint8_t BMSTransferQueue::poll() {
+    uint32_t delivered = _stats.completed + _stats.failed;
+
+    if (_count > 0 && !_inFlight) {
+        start();
+    }
+    if (_inFlight) {
+        BMSLib::Status status;
+        if (_gauge.pollRead(status)) {
+            _inFlight = false;
+            if (status != BMSLib::Status::OK || !advance()) {
+                complete(status);
+            }
+#ifdef BMS_BUS_ASYNC
+            // Hand the bus engine the next read or chunk before returning to the sketch
+            if (_count > 0) {
+                start();
+            }
+#endif
+        }
+    }
+
+    return static_cast<uint8_t>(_stats.completed + _stats.failed - delivered);
+}
+
+void BMSTransferQueue::flush() {
+    while (_count > 0) {
+        if (poll() == 0) {
+            yield();
+        }
+    }
+}
+
+uint8_t BMSTransferQueue::getPending() const {
+    return _count;
+}
+
+bool BMSTransferQueue::isIdle() const {
+    return _count == 0;
+}
+
+const BMSTransferQueue::Stats& BMSTransferQueue::getStats() const {
+    return _stats;
+}
+
+void BMSTransferQueue::resetStats() {
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+BMSTransferQueue::Transfer* BMSTransferQueue::push(Kind kind, uint8_t command, uint8_t length,
+                                                   void* context) {
+    if (_count >= BMS_TRANSFER_QUEUE_SIZE) {
+        _stats.rejected++;
+        return nullptr;
+    }
+
+    Transfer& transfer = _queue[(_head + _count) % BMS_TRANSFER_QUEUE_SIZE];
+    transfer.kind = kind;
+    transfer.command = command;
+    transfer.length = length;
+    transfer.offset = 0;
+    transfer.field = 0;
+    transfer.context = context;
+
+    _count++;
+    _stats.submitted++;
+    if (_count > _stats.maxDepth) {
+        _stats.maxDepth = _count;
+    }
+    return &transfer;
+}
+
+// Leaves the transfer queued while the gauge is busy with another caller's read.
+// A read that fails to start completes at once with its error.
+void BMSTransferQueue::start() {
+    Transfer& transfer = _queue[_head];
+    uint8_t* data = transfer.kind == Kind::READ ? transfer.target.data : _buffer + transfer.offset;
+    uint8_t length = transfer.length - transfer.offset;
+    if (transfer.kind == Kind::SNAPSHOT && length > SNAPSHOT_CHUNK) {
+        length = SNAPSHOT_CHUNK;
+    }
+
+    BMSLib::Status status = _gauge.startRead(transfer.command + transfer.offset, data, length);
+    if (status == BMSLib::Status::OK) {
+        _inFlight = true;
+    } else if (status != BMSLib::Status::BUSY) {
+        complete(status);
+    }
+}
+
+// Moves a chunked snapshot on to its next chunk; false once the transfer is complete
+bool BMSTransferQueue::advance() {
+    Transfer& transfer = _queue[_head];
+    if (transfer.kind != Kind::SNAPSHOT) {
+        return false;
+    }
+    uint8_t remaining = transfer.length - transfer.offset;
+    transfer.offset += remaining > SNAPSHOT_CHUNK ? SNAPSHOT_CHUNK : remaining;
+    return transfer.offset < transfer.length;
+}
+
+void BMSTransferQueue::complete(BMSLib::Status status) {
+    // Pop first so the callback can submit follow-up reads
+    Transfer transfer = _queue[_head];
+    _head = (_head + 1) % BMS_TRANSFER_QUEUE_SIZE;
+    _count--;
+
+    switch (transfer.kind) {
+        case Kind::READ:
+            if (transfer.callback.read != nullptr) {
+                transfer.callback.read(status, transfer.target.data, transfer.length, transfer.context);
+            }
+            break;
+
+        case Kind::FIELD: {
+            BMSLib::Field field = static_cast<BMSLib::Field>(transfer.field);
+            uint16_t value = 0;
+            if (status == BMSLib::Status::OK && !_gauge.decodeField(field, _buffer, value)) {
+                status = BMSLib::Status::OUT_OF_RANGE;
+            }
+            if (transfer.callback.field != nullptr) {
+                transfer.callback.field(field, status, value, transfer.context);
+            }
+            break;
+        }
+
+        case Kind::SNAPSHOT:
+            if (status == BMSLib::Status::OK) {
+                uint8_t transactions = (transfer.length + SNAPSHOT_CHUNK - 1) / SNAPSHOT_CHUNK;
+                _gauge.decodeStatusSnapshot(_buffer, *transfer.target.snapshot);
+                transfer.target.snapshot->transactions = transactions;
+                transfer.target.snapshot->bytes = 3 * transactions + transfer.length;
+                _gauge.notifySnapshotListeners(*transfer.target.snapshot);
+            }
+            if (transfer.callback.snapshot != nullptr) {
+                transfer.callback.snapshot(status, *transfer.target.snapshot, transfer.context);
+            }
+            break;
+    }
+
+    if (status == BMSLib::Status::OK) {
+        _stats.completed++;
+    } else {
+        _stats.failed++;
+    }
+}
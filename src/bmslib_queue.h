@@ -0,0 +1,90 @@
+#ifndef BMSLIB_QUEUE_H
+#define BMSLIB_QUEUE_H
+
+#include "BMSLib.h"
+
+// Transfers that can wait in the queue behind the one in flight
+#ifndef BMS_TRANSFER_QUEUE_SIZE
+#define BMS_TRANSFER_QUEUE_SIZE 4
+#endif
+
+// Queue of gauge reads with completion callbacks. Reads are submitted from anywhere in
+// the sketch; poll() from loop() starts the next one and delivers each result once the
+// bus reports it done. With a BMS_BUS_ASYNC backend the bytes move on the I2C engine
+// while the CPU keeps working. On other targets each poll() runs one read to completion.
+class BMSTransferQueue {
+public:
+    struct Stats {
+        uint32_t submitted;     // Transfers accepted
+        uint32_t completed;     // Callbacks delivered with Status::OK
+        uint32_t failed;        // Callbacks delivered with an error status
+        uint32_t rejected;      // Submissions refused because the queue was full
+        uint8_t maxDepth;       // Deepest the queue has been
+    };
+
+    typedef void (*ReadCallback)(BMSLib::Status status, const uint8_t* data, uint8_t length, void* context);
+    typedef void (*FieldCallback)(BMSLib::Field field, BMSLib::Status status, uint16_t value, void* context);
+    typedef void (*SnapshotCallback)(BMSLib::Status status, const BMSLib::StatusSnapshot& snapshot, void* context);
+
+    explicit BMSTransferQueue(BMSLib& gauge);
+
+    // Raw burst read into a caller buffer, which must stay valid until the callback
+    bool submitRead(uint8_t command, uint8_t* data, uint8_t length,
+                    ReadCallback callback, void* context = nullptr);
+    // One field, decoded and range-checked like readField()
+    bool submitField(BMSLib::Field field, FieldCallback callback, void* context = nullptr);
+    // Status snapshot, decoded into the caller's struct; snapshot listeners run too. Read
+    // in one burst, or in word-aligned chunks when the Wire buffer is smaller
+    bool submitSnapshot(BMSLib::StatusSnapshot& snapshot, SnapshotCallback callback,
+                        void* context = nullptr);
+
+    // Advance the queue; returns the number of callbacks delivered
+    uint8_t poll();
+    // Poll until every queued transfer has completed
+    void flush();
+
+    uint8_t getPending() const;
+    bool isIdle() const;
+    const Stats& getStats() const;
+    void resetStats();
+
+private:
+    enum class Kind : uint8_t {
+        READ,
+        FIELD,
+        SNAPSHOT
+    };
+
+    struct Transfer {
+        Kind kind;
+        uint8_t command;
+        uint8_t length;
+        uint8_t offset;         // Bytes already read; snapshots move in chunks
+        uint8_t field;
+        union {
+            uint8_t* data;
+            BMSLib::StatusSnapshot* snapshot;
+        } target;
+        union {
+            ReadCallback read;
+            FieldCallback field;
+            SnapshotCallback snapshot;
+        } callback;
+        void* context;
+    };
+
+    BMSLib& _gauge;
+    Transfer _queue[BMS_TRANSFER_QUEUE_SIZE];
+    uint8_t _head;
+    uint8_t _count;
+    bool _inFlight;
+    uint8_t _buffer[BMS_SNAPSHOT_LENGTH];  // Scratch for field and snapshot reads
+    Stats _stats;
+
+    Transfer* push(Kind kind, uint8_t command, uint8_t length, void* context);
+    void start();
+    bool advance();
+    void complete(BMSLib::Status status);
+};
+
+#endif // BMSLIB_QUEUE_H
@@ -0,0 +1,257 @@
+#include "bmslib_sched.h"
+
+BMSBusScheduler::BMSBusScheduler(BMSLib& gauge) :
+    _gauge(gauge),
+    _safetyIntervalUs(BMS_SCHED_SAFETY_INTERVAL * 1000UL),
+    _safetyMaxGapUs(BMS_SCHED_SAFETY_MAX_GAP * 1000UL),
+    _telemetryIntervalMs(1000),
+    _lastSafetyUs(0),
+    _lastTelemetryMs(0),
+    _sampled(false),
+    _safetyFresh(false),
+    _safetyCallback(nullptr),
+    _safetyContext(nullptr),
+    _snapshotCallback(nullptr),
+    _snapshotContext(nullptr),
+    _jobHead(0),
+    _jobCount(0),
+    _config(ConfigState::IDLE),
+    _op(0) {
+    // FLAGS (0x0E) and Current (0x10) are adjacent: one burst read
+    BMSLib::compileReadPlan(BMSLib::fieldMask(BMSLib::Field::FLAGS) |
+                            BMSLib::fieldMask(BMSLib::Field::CURRENT), _safetyPlan);
+    memset(&_snapshot, 0, sizeof(_snapshot));
+    resetStats();
+}
+
+bool BMSBusScheduler::setSafetyInterval(uint16_t intervalMs, uint16_t maxGapMs) {
+    if (intervalMs == 0 || maxGapMs < intervalMs) {
+        return false;
+    }
+    _safetyIntervalUs = intervalMs * 1000UL;
+    _safetyMaxGapUs = maxGapMs * 1000UL;
+    return true;
+}
+
+void BMSBusScheduler::setTelemetryInterval(uint32_t intervalMs) {
+    _telemetryIntervalMs = intervalMs;
+}
+
+void BMSBusScheduler::setSafetyCallback(SafetyCallback callback, void* context) {
+    _safetyCallback = callback;
+    _safetyContext = context;
+}
+
+void BMSBusScheduler::setSnapshotCallback(BMSLib::SnapshotListener callback, void* context) {
+    _snapshotCallback = callback;
+    _snapshotContext = context;
+}
+
+bool BMSBusScheduler::readBlock(uint8_t subclass, uint8_t block, uint8_t* data,
+                                JobCallback callback, void* context) {
+    return pushJob(false, subclass, block, data, callback, context);
+}
+
+bool BMSBusScheduler::writeBlock(uint8_t subclass, uint8_t block, const uint8_t* data,
+                                 JobCallback callback, void* context) {
+    // Never written through: the pointer is only handed back to writeDataFlashBlock()
+    return pushJob(true, subclass, block, const_cast<uint8_t*>(data), callback, context);
+}
+
+void BMSBusScheduler::poll() {
+    uint32_t now = micros();
+
+    if (!_sampled || now - _lastSafetyUs >= _safetyIntervalUs) {
+        readSafety(now);
+        return;
+    }
+
+    if (_telemetryIntervalMs > 0 && millis() - _lastTelemetryMs >= _telemetryIntervalMs) {
+        readTelemetry(now);
+        return;
+    }
+
+    if (!advanceConfig()) {
+        return;
+    }
+
+    // Run the block only if it ends inside the safety gap at its worst measured length,
+    // taking a safety read first when it would not. A step longer than the whole gap can
+    // never fit, so it runs as soon as no step has run since the last safety read.
+    uint32_t cost = _stats.bulkSteps > 0 ? _stats.maxBulkStepUs : BMS_SCHED_BULK_ESTIMATE_US;
+    bool oversized = cost >= _safetyMaxGapUs;
+    if (now - _lastSafetyUs + cost > _safetyMaxGapUs && !(oversized && _safetyFresh)) {
+        _stats.deferrals++;
+        if (!readSafety(now)) {
+            return;
+        }
+    }
+    runBulkStep();
+}
+
+uint8_t BMSBusScheduler::getPendingJobs() const {
+    return _jobCount;
+}
+
+const BMSLib::StatusSnapshot& BMSBusScheduler::getSnapshot() const {
+    return _snapshot;
+}
+
+const BMSBusScheduler::Stats& BMSBusScheduler::getStats() const {
+    return _stats;
+}
+
+void BMSBusScheduler::resetStats() {
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+bool BMSBusScheduler::pushJob(bool write, uint8_t subclass, uint8_t block, uint8_t* data,
+                              JobCallback callback, void* context) {
+    if (_jobCount >= BMS_SCHED_MAX_JOBS || data == nullptr) {
+        return false;
+    }
+
+    Job& job = _jobs[(_jobHead + _jobCount) % BMS_SCHED_MAX_JOBS];
+    job.write = write;
+    job.subclass = subclass;
+    job.block = block;
+    job.data = data;
+    job.callback = callback;
+    job.context = context;
+    _jobCount++;
+    return true;
+}
+
+bool BMSBusScheduler::readSafety(uint32_t now) {
+    BMSLib::FieldValues values;
+
+    // Only a read that succeeded restarts the gap; after a failure the next poll()
+    // tries again and no bulk step runs in between
+    if (!_gauge.executeReadPlan(_safetyPlan, values)) {
+        _stats.failures++;
+        return false;
+    }
+    noteSafety(now);
+    _stats.safetyReads++;
+
+    if (_safetyCallback != nullptr) {
+        _safetyCallback(values.get(BMSLib::Field::FLAGS),
+                        values.getSigned(BMSLib::Field::CURRENT), _safetyContext);
+    }
+    return true;
+}
+
+void BMSBusScheduler::readTelemetry(uint32_t now) {
+    _lastTelemetryMs = millis();
+
+    // The snapshot window covers FLAGS and Current, so it doubles as a safety read
+    if (!_gauge.readStatusSnapshot(_snapshot)) {
+        _stats.failures++;
+        return;
+    }
+    noteSafety(now);
+    _stats.telemetryReads++;
+
+    // Raw current: the range-checked field reads 0 for the overcurrent this must report
+    if (_safetyCallback != nullptr) {
+        _safetyCallback(_snapshot.flags, _snapshot.rawCurrent, _safetyContext);
+    }
+    if (_snapshotCallback != nullptr) {
+        _snapshotCallback(_snapshot, _snapshotContext);
+    }
+}
+
+// Steps config mode with the non-blocking operations; true when a block may run now
+bool BMSBusScheduler::advanceConfig() {
+    BMSLib::OpState state;
+
+    switch (_config) {
+        case ConfigState::IDLE:
+            if (_jobCount > 0) {
+                _op = _gauge.enterConfigModeAsync();
+                if (_op != 0) {
+                    _config = ConfigState::ENTERING;
+                }
+            }
+            return false;
+
+        case ConfigState::ENTERING:
+            _gauge.poll();
+            state = _gauge.getOpState(_op);
+            if (state == BMSLib::OpState::PENDING) {
+                return false;
+            }
+            if (state == BMSLib::OpState::DONE) {
+                _config = ConfigState::ACTIVE;
+                return true;
+            }
+            // Could not enter config mode: fail every queued job
+            while (_jobCount > 0) {
+                Job job = _jobs[_jobHead];
+                _jobHead = (_jobHead + 1) % BMS_SCHED_MAX_JOBS;
+                _jobCount--;
+                _stats.failures++;
+                if (job.callback != nullptr) {
+                    job.callback(false, job.subclass, job.block, job.context);
+                }
+            }
+            _config = ConfigState::IDLE;
+            return false;
+
+        case ConfigState::ACTIVE:
+            if (_jobCount > 0) {
+                return true;
+            }
+            _op = _gauge.exitConfigModeAsync();
+            if (_op != 0) {
+                _config = ConfigState::EXITING;
+            }
+            return false;
+
+        case ConfigState::EXITING:
+            _gauge.poll();
+            state = _gauge.getOpState(_op);
+            if (state == BMSLib::OpState::PENDING) {
+                return false;
+            }
+            if (state == BMSLib::OpState::FAILED) {
+                _stats.failures++;
+            }
+            _config = ConfigState::IDLE;
+            return false;
+    }
+    return false;
+}
+
+void BMSBusScheduler::runBulkStep() {
+    Job job = _jobs[_jobHead];
+    _jobHead = (_jobHead + 1) % BMS_SCHED_MAX_JOBS;
+    _jobCount--;
+
+    uint32_t start = micros();
+    bool success = job.write ?
+        _gauge.writeDataFlashBlock(job.subclass, job.block, job.data) :
+        _gauge.readDataFlashBlock(job.subclass, job.block, job.data);
+    uint32_t elapsed = micros() - start;
+
+    _safetyFresh = false;
+    _stats.bulkSteps++;
+    if (elapsed > _stats.maxBulkStepUs) {
+        _stats.maxBulkStepUs = elapsed;
+    }
+    if (!success) {
+        _stats.failures++;
+    }
+    if (job.callback != nullptr) {
+        job.callback(success, job.subclass, job.block, job.context);
+    }
+}
+
+void BMSBusScheduler::noteSafety(uint32_t now) {
+    if (_sampled && now - _lastSafetyUs > _stats.maxSafetyGapUs) {
+        _stats.maxSafetyGapUs = now - _lastSafetyUs;
+    }
+    _lastSafetyUs = now;
+    _sampled = true;
+    _safetyFresh = true;
+}
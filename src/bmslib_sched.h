@@ -0,0 +1,107 @@
+#ifndef BMSLIB_SCHED_H
+#define BMSLIB_SCHED_H
+
+#include "BMSLib.h"
+
+// Data-flash jobs that can wait behind the running one
+#ifndef BMS_SCHED_MAX_JOBS
+#define BMS_SCHED_MAX_JOBS      4
+#endif
+
+#define BMS_SCHED_SAFETY_INTERVAL   50      // Default FLAGS/current period (ms)
+#define BMS_SCHED_SAFETY_MAX_GAP    100     // Default worst-case gap between safety reads (ms)
+#define BMS_SCHED_BULK_ESTIMATE_US  10000   // Block step cost assumed until one is measured
+
+// Priority bus arbiter for one gauge. Three classes share the bus, highest first:
+//   safety     FLAGS and current, one 4-byte burst, on a fixed period
+//   telemetry  the status snapshot, on its own period (also counts as a safety read)
+//   bulk       data-flash block reads and writes, one block per step
+// Bulk jobs never hold the bus for more than one block: config mode is entered and left
+// with the non-blocking operations, so safety reads continue through the settle waits.
+// Before each block the arbiter checks that the step, at its longest measured duration,
+// still ends inside the safety gap; if not, the safety read goes first.
+class BMSBusScheduler {
+public:
+    struct Stats {
+        uint32_t safetyReads;
+        uint32_t telemetryReads;
+        uint32_t bulkSteps;         // Data-flash blocks transferred
+        uint32_t deferrals;         // Bulk steps held back to protect the safety gap
+        uint32_t failures;          // Failed reads or bulk steps
+        uint32_t maxSafetyGapUs;    // Longest observed time between safety reads
+        uint32_t maxBulkStepUs;     // Longest bulk step, used as its cost estimate
+    };
+
+    typedef void (*SafetyCallback)(uint16_t flags, int16_t current, void* context);
+    typedef void (*JobCallback)(bool success, uint8_t subclass, uint8_t block, void* context);
+
+    explicit BMSBusScheduler(BMSLib& gauge);
+
+    // Period and worst-case gap for safety reads; maxGapMs >= intervalMs
+    bool setSafetyInterval(uint16_t intervalMs, uint16_t maxGapMs);
+    void setTelemetryInterval(uint32_t intervalMs);   // 0 disables telemetry reads
+    void setSafetyCallback(SafetyCallback callback, void* context = nullptr);
+    void setSnapshotCallback(BMSLib::SnapshotListener callback, void* context = nullptr);
+
+    // Queue a 32-byte data-flash block transfer; the buffer must outlive the job
+    bool readBlock(uint8_t subclass, uint8_t block, uint8_t* data,
+                   JobCallback callback = nullptr, void* context = nullptr);
+    bool writeBlock(uint8_t subclass, uint8_t block, const uint8_t* data,
+                    JobCallback callback = nullptr, void* context = nullptr);
+
+    // Run at most one bus transaction or bulk step; call from loop()
+    void poll();
+
+    uint8_t getPendingJobs() const;
+    const BMSLib::StatusSnapshot& getSnapshot() const;
+    const Stats& getStats() const;
+    void resetStats();
+
+private:
+    enum class ConfigState : uint8_t {
+        IDLE,       // Not in config mode on our behalf
+        ENTERING,
+        ACTIVE,
+        EXITING
+    };
+
+    struct Job {
+        bool write;
+        uint8_t subclass;
+        uint8_t block;
+        uint8_t* data;
+        JobCallback callback;
+        void* context;
+    };
+
+    BMSLib& _gauge;
+    uint32_t _safetyIntervalUs;
+    uint32_t _safetyMaxGapUs;
+    uint32_t _telemetryIntervalMs;
+    uint32_t _lastSafetyUs;
+    uint32_t _lastTelemetryMs;
+    bool _sampled;
+    bool _safetyFresh;          // No bulk step since the last safety read
+    SafetyCallback _safetyCallback;
+    void* _safetyContext;
+    BMSLib::SnapshotListener _snapshotCallback;
+    void* _snapshotContext;
+    BMSLib::ReadPlan _safetyPlan;
+    BMSLib::StatusSnapshot _snapshot;
+    Job _jobs[BMS_SCHED_MAX_JOBS];
+    uint8_t _jobHead;
+    uint8_t _jobCount;
+    ConfigState _config;
+    BMSLib::OpHandle _op;
+    Stats _stats;
+
+    bool pushJob(bool write, uint8_t subclass, uint8_t block, uint8_t* data,
+                 JobCallback callback, void* context);
+    bool readSafety(uint32_t now);
+    void readTelemetry(uint32_t now);
+    bool advanceConfig();
+    void runBulkStep();
+    void noteSafety(uint32_t now);
+};
+
+#endif // BMSLIB_SCHED_H
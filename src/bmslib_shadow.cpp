@@ -0,0 +1,270 @@
+#include "BMSLib.h"
+
+// RAM shadow of data flash blocks. A block is read from the gauge once (inside a
+// config-mode scope) and later reads are served from RAM without touching the bus.
+// Writes only modify the shadow and widen the block's dirty range; flushShadow()
+// commits each dirty block by sending just that range plus the block checksum.
+// Memory use is BMS_SHADOW_BLOCKS * 38 bytes; least recently used blocks are
+// evicted (and flushed first if dirty) when more blocks are touched. Subclasses the
+// gauge rewrites on its own bypass the shadow, since a RAM copy of them goes stale.
+
+namespace {
+
+// Lifetime Data and State (last charge date/time, Qmax updates)
+const uint8_t SHADOW_BYPASS[] = { 59, 82 };
+
+bool shadowBypassed(uint8_t subclass) {
+    for (uint8_t i = 0; i < sizeof(SHADOW_BYPASS); i++) {
+        if (SHADOW_BYPASS[i] == subclass) {
+            return true;
+        }
+    }
+    return false;
+}
+
+}  // namespace
+
+bool BMSLib::readShadow(uint8_t subclass, uint8_t offset, uint8_t* data, uint8_t length) {
+    if (BMS_SHADOW_BLOCKS == 0 || shadowBypassed(subclass)) {
+        return readDataFlashDirect(subclass, offset, data, length);
+    }
+
+#if BMS_SHADOW_BLOCKS > 0
+    bool scoped = false;
+    bool success = true;
+
+    while (length > 0) {
+        uint8_t block = offset / BMS_DATAFLASH_BLOCK_SIZE;
+        uint8_t position = offset % BMS_DATAFLASH_BLOCK_SIZE;
+        uint8_t chunk = BMS_DATAFLASH_BLOCK_SIZE - position;
+        if (chunk > length) chunk = length;
+
+        // Config mode is only needed when a block has to come from the gauge
+        ShadowBlock* slot = shadowFind(subclass, block);
+        if (slot == nullptr) {
+            if (!scoped) {
+                if (!beginConfig()) {
+                    return false;
+                }
+                scoped = true;
+            }
+            slot = shadowLoad(subclass, block);
+            if (slot == nullptr) {
+                success = false;
+                break;
+            }
+        }
+
+        memcpy(data, slot->data + position, chunk);
+        offset += chunk;
+        data += chunk;
+        length -= chunk;
+    }
+
+    return scoped ? endConfig(success) : success;
+#else
+    return false;
+#endif
+}
+
+bool BMSLib::writeShadow(uint8_t subclass, uint8_t offset, const uint8_t* data, uint8_t length) {
+    if (BMS_SHADOW_BLOCKS == 0 || shadowBypassed(subclass)) {
+        return writeDataFlashDirect(subclass, offset, data, length);
+    }
+
+#if BMS_SHADOW_BLOCKS > 0
+    bool scoped = false;
+    bool success = true;
+
+    while (length > 0) {
+        uint8_t block = offset / BMS_DATAFLASH_BLOCK_SIZE;
+        uint8_t position = offset % BMS_DATAFLASH_BLOCK_SIZE;
+        uint8_t chunk = BMS_DATAFLASH_BLOCK_SIZE - position;
+        if (chunk > length) chunk = length;
+
+        // The whole block is needed to compute its checksum on flush
+        ShadowBlock* slot = shadowFind(subclass, block);
+        if (slot == nullptr) {
+            if (!scoped) {
+                if (!beginConfig()) {
+                    return false;
+                }
+                scoped = true;
+            }
+            slot = shadowLoad(subclass, block);
+            if (slot == nullptr) {
+                success = false;
+                break;
+            }
+        }
+
+        for (uint8_t i = 0; i < chunk; i++) {
+            uint8_t index = position + i;
+            if (slot->data[index] == data[i]) {
+                continue;
+            }
+            slot->data[index] = data[i];
+            if (slot->dirtyTo == 0 || index < slot->dirtyFrom) slot->dirtyFrom = index;
+            if (index + 1 > slot->dirtyTo) slot->dirtyTo = index + 1;
+        }
+
+        offset += chunk;
+        data += chunk;
+        length -= chunk;
+    }
+
+    return scoped ? endConfig(success) : success;
+#else
+    return false;
+#endif
+}
+
+bool BMSLib::readDataFlashDirect(uint8_t subclass, uint8_t offset, uint8_t* data, uint8_t length) {
+    // Straight from the gauge, one block at a time
+    if (!beginConfig()) {
+        return false;
+    }
+    bool success = selectDataFlashBlock(subclass, offset / BMS_DATAFLASH_BLOCK_SIZE) &&
+                   readDataFlash(offset % BMS_DATAFLASH_BLOCK_SIZE, data, length);
+    return endConfig(success);
+}
+
+bool BMSLib::writeDataFlashDirect(uint8_t subclass, uint8_t offset, const uint8_t* data, uint8_t length) {
+    // Read-modify-write the block on the gauge
+    if (!beginConfig()) {
+        return false;
+    }
+    bool success = selectDataFlashBlock(subclass, offset / BMS_DATAFLASH_BLOCK_SIZE) &&
+                   writeDataFlash(offset % BMS_DATAFLASH_BLOCK_SIZE, data, length);
+    return endConfig(success);
+}
+
+bool BMSLib::flushShadow() {
+#if BMS_SHADOW_BLOCKS > 0
+    if (!isShadowDirty()) {
+        return true;
+    }
+
+    // A block that cannot be committed is dropped rather than left dirty, so a later
+    // flush never writes stale changes and the next read sees what the gauge holds
+    const bool scoped = beginConfig();
+    bool success = scoped;
+    for (uint8_t i = 0; i < BMS_SHADOW_BLOCKS; i++) {
+        ShadowBlock& slot = _shadow[i];
+        if (!slot.loaded || slot.dirtyTo == 0) {
+            continue;
+        }
+        if (scoped) {
+            success &= shadowFlushBlock(slot);
+        } else {
+            slot.loaded = false;
+            slot.dirtyTo = 0;
+        }
+    }
+    return scoped ? endConfig(success) : false;
+#else
+    return true;
+#endif
+}
+
+void BMSLib::invalidateShadow() {
+#if BMS_SHADOW_BLOCKS > 0
+    for (uint8_t i = 0; i < BMS_SHADOW_BLOCKS; i++) {
+        _shadow[i].loaded = false;
+        _shadow[i].dirtyTo = 0;
+    }
+#endif
+}
+
+bool BMSLib::isShadowDirty() const {
+#if BMS_SHADOW_BLOCKS > 0
+    for (uint8_t i = 0; i < BMS_SHADOW_BLOCKS; i++) {
+        if (_shadow[i].loaded && _shadow[i].dirtyTo != 0) {
+            return true;
+        }
+    }
+#endif
+    return false;
+}
+
+BMSLib::ShadowBlock* BMSLib::shadowFind(uint8_t subclass, uint8_t block) {
+#if BMS_SHADOW_BLOCKS > 0
+    for (uint8_t i = 0; i < BMS_SHADOW_BLOCKS; i++) {
+        ShadowBlock& slot = _shadow[i];
+        if (slot.loaded && slot.subclass == subclass && slot.block == block) {
+            slot.lastUse = ++_shadowClock;
+            return &slot;
+        }
+    }
+#else
+    (void)subclass;
+    (void)block;
+#endif
+    return nullptr;
+}
+
+BMSLib::ShadowBlock* BMSLib::shadowLoad(uint8_t subclass, uint8_t block) {
+#if BMS_SHADOW_BLOCKS > 0
+    // Take a free slot, otherwise the least recently used one
+    ShadowBlock* victim = nullptr;
+    for (uint8_t i = 0; i < BMS_SHADOW_BLOCKS; i++) {
+        ShadowBlock& slot = _shadow[i];
+        if (!slot.loaded) {
+            victim = &slot;
+            break;
+        }
+        if (victim == nullptr ||
+            (uint8_t)(_shadowClock - slot.lastUse) > (uint8_t)(_shadowClock - victim->lastUse)) {
+            victim = &slot;
+        }
+    }
+
+    if (victim->loaded && victim->dirtyTo != 0 && !shadowFlushBlock(*victim)) {
+        return nullptr;
+    }
+
+    victim->loaded = false;
+    victim->dirtyTo = 0;
+    if (!readDataFlashBlock(subclass, block, victim->data)) {
+        return nullptr;
+    }
+
+    victim->subclass = subclass;
+    victim->block = block;
+    victim->loaded = true;
+    victim->lastUse = ++_shadowClock;
+    return victim;
+#else
+    (void)subclass;
+    (void)block;
+    return nullptr;
+#endif
+}
+
+bool BMSLib::shadowFlushBlock(ShadowBlock& slot) {
+    if (!selectDataFlashBlock(slot.subclass, slot.block) ||
+        !commitDataFlash(slot.data, slot.dirtyFrom, slot.dirtyTo)) {
+        // The gauge may hold the old block, the new one or neither: reload on next use
+        slot.loaded = false;
+        slot.dirtyTo = 0;
+        return false;
+    }
+    slot.dirtyTo = 0;
+    return true;
+}
+
+void BMSLib::shadowUpdate(uint8_t subclass, uint8_t block, const uint8_t* data) {
+#if BMS_SHADOW_BLOCKS > 0
+    for (uint8_t i = 0; i < BMS_SHADOW_BLOCKS; i++) {
+        ShadowBlock& slot = _shadow[i];
+        if (slot.loaded && slot.subclass == subclass && slot.block == block) {
+            memcpy(slot.data, data, BMS_DATAFLASH_BLOCK_SIZE);
+            slot.dirtyTo = 0;
+        }
+    }
+#else
+    (void)subclass;
+    (void)block;
+    (void)data;
+#endif
+}
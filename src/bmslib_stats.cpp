@@ -0,0 +1,295 @@
+#include "bmslib_stats.h"
+
+namespace {
+
+#if BMS_STATS_QUANTILES
+// Marker quantiles for P50/P95/P99 plus their midpoints (extended P²), Q16
+const uint32_t MARKER_FRACTION[BMS_STATS_MARKERS] = {
+    0, 16384, 32768, 47514, 62259, 63570, 64881, 65208, 65536
+};
+const uint8_t MARKER_P50 = 2;
+const uint8_t MARKER_P95 = 4;
+const uint8_t MARKER_P99 = 6;
+const int32_t ONE_Q16 = 65536;
+#endif
+
+const uint32_t DEFAULT_WINDOWS[] = { 1000, 60000, 3600000 };
+
+}  // namespace
+
+BMSStreamStats::BMSStreamStats(Channel channel) :
+    _channel(channel),
+    _gauge(nullptr) {
+    memset(_windows, 0, sizeof(_windows));
+    for (uint8_t i = 0; i < BMS_STATS_MAX_WINDOWS && i < 3; i++) {
+        _windows[i].lengthMs = DEFAULT_WINDOWS[i];
+    }
+    reset();
+}
+
+BMSStreamStats::~BMSStreamStats() {
+    detach();
+}
+
+bool BMSStreamStats::setWindow(uint8_t index, uint32_t windowMs) {
+    if (index >= BMS_STATS_MAX_WINDOWS) {
+        return false;
+    }
+    _windows[index].lengthMs = windowMs;
+    _windows[index].completed = false;
+    restart(_windows[index], millis());
+    return true;
+}
+
+bool BMSStreamStats::attach(BMSLib& gauge) {
+    detach();
+    if (!gauge.addSnapshotListener(onSnapshot, this)) {
+        return false;
+    }
+    _gauge = &gauge;
+    return true;
+}
+
+void BMSStreamStats::detach() {
+    if (_gauge != nullptr) {
+        _gauge->removeSnapshotListener(onSnapshot, this);
+        _gauge = nullptr;
+    }
+}
+
+void BMSStreamStats::add(int32_t value) {
+    add(value, millis());
+}
+
+void BMSStreamStats::add(int32_t value, uint32_t now) {
+    for (uint8_t i = 0; i < BMS_STATS_MAX_WINDOWS; i++) {
+        Window& window = _windows[i];
+        if (window.lengthMs == 0) {
+            continue;
+        }
+
+        // Close the window the sample falls after; idle gaps skip whole windows
+        if (now - window.start >= window.lengthMs) {
+            summarize(window, window.last, window.start + window.lengthMs);
+            window.completed = true;
+            uint32_t periods = (now - window.start) / window.lengthMs;
+            restart(window, window.start + periods * window.lengthMs);
+        }
+        accumulate(window, value);
+    }
+}
+
+void BMSStreamStats::reset() {
+    uint32_t now = millis();
+    for (uint8_t i = 0; i < BMS_STATS_MAX_WINDOWS; i++) {
+        _windows[i].completed = false;
+        restart(_windows[i], now);
+    }
+}
+
+bool BMSStreamStats::getSummary(uint8_t index, Summary& summary) const {
+    if (index >= BMS_STATS_MAX_WINDOWS || !_windows[index].completed) {
+        return false;
+    }
+    summary = _windows[index].last;
+    return true;
+}
+
+bool BMSStreamStats::getRunning(uint8_t index, Summary& summary) const {
+    if (index >= BMS_STATS_MAX_WINDOWS || _windows[index].lengthMs == 0) {
+        return false;
+    }
+    summarize(_windows[index], summary, millis());
+    return true;
+}
+
+void BMSStreamStats::onSnapshot(const BMSLib::StatusSnapshot& snapshot, void* context) {
+    BMSStreamStats* self = static_cast<BMSStreamStats*>(context);
+    // Raw readings: the range-checked fields turn the extremes a window should show into 0
+    switch (self->_channel) {
+        case Channel::CURRENT:
+            self->add(snapshot.rawCurrent);
+            break;
+        case Channel::AVERAGE_CURRENT:
+            self->add(snapshot.averageCurrent);
+            break;
+        case Channel::VOLTAGE:
+            self->add(snapshot.rawVoltage);
+            break;
+        case Channel::TEMPERATURE:
+            self->add(snapshot.rawTemperature);
+            break;
+    }
+}
+
+void BMSStreamStats::summarize(const Window& window, Summary& summary, uint32_t now) {
+    memset(&summary, 0, sizeof(summary));
+    summary.start = window.start;
+    summary.duration = now - window.start;
+    summary.count = window.count;
+    if (window.count == 0) {
+        return;
+    }
+
+    summary.min = window.min;
+    summary.max = window.max;
+
+    // Sums are relative to the first sample, which keeps them small and exact
+    int64_t n = window.count;
+    int64_t sum = window.sum;
+    int64_t half = sum >= 0 ? n / 2 : -n / 2;
+    summary.mean = window.offset + (int32_t)((sum + half) / n);
+
+    uint64_t spread = window.sumSquares - (uint64_t)((sum * sum) / n);
+    uint64_t variance = spread / window.count;
+    summary.variance = variance > UINT32_MAX ? UINT32_MAX : (uint32_t)variance;
+    summary.stddev = isqrt(summary.variance);
+
+#if BMS_STATS_QUANTILES
+    summary.p50 = quantileGet(window.quantiles, window.count, MARKER_P50);
+    summary.p95 = quantileGet(window.quantiles, window.count, MARKER_P95);
+    summary.p99 = quantileGet(window.quantiles, window.count, MARKER_P99);
+#endif
+}
+
+void BMSStreamStats::restart(Window& window, uint32_t now) {
+    window.start = now;
+    window.count = 0;
+    window.offset = 0;
+    window.min = 0;
+    window.max = 0;
+    window.sum = 0;
+    window.sumSquares = 0;
+}
+
+void BMSStreamStats::accumulate(Window& window, int32_t value) {
+    if (window.count == 0) {
+        window.offset = value;
+        window.min = value;
+        window.max = value;
+    }
+    if (value < window.min) window.min = value;
+    if (value > window.max) window.max = value;
+
+    // 16-bit inputs give deltas up to 17 bits; square in 32 bits when that is safe
+    int32_t delta = value - window.offset;
+    uint32_t magnitude = delta < 0 ? -delta : delta;
+    window.sum += delta;
+    window.sumSquares += magnitude <= 46340 ? (uint64_t)(magnitude * magnitude)
+                                            : (uint64_t)magnitude * magnitude;
+
+#if BMS_STATS_QUANTILES
+    quantileAdd(window.quantiles, window.count, value);
+#endif
+    window.count++;
+}
+
+#if BMS_STATS_QUANTILES
+void BMSStreamStats::quantileAdd(Quantiles& q, uint32_t count, int32_t value) {
+    int32_t height = value * 256;
+
+    // Until every marker has a sample, keep the samples sorted in the marker array
+    if (count < BMS_STATS_MARKERS) {
+        uint8_t i = count;
+        while (i > 0 && q.height[i - 1] > height) {
+            q.height[i] = q.height[i - 1];
+            i--;
+        }
+        q.height[i] = height;
+
+        if (count == BMS_STATS_MARKERS - 1) {
+            for (uint8_t m = 0; m < BMS_STATS_MARKERS; m++) {
+                q.position[m] = m + 1;
+                q.drift[m] = (int32_t)(MARKER_FRACTION[m] * (BMS_STATS_MARKERS - 1)) - m * ONE_Q16;
+            }
+        }
+        return;
+    }
+
+    // Find the cell the sample falls in, stretching the extremes if needed
+    uint8_t cell;
+    if (height < q.height[0]) {
+        q.height[0] = height;
+        cell = 0;
+    } else if (height >= q.height[BMS_STATS_MARKERS - 1]) {
+        q.height[BMS_STATS_MARKERS - 1] = height;
+        cell = BMS_STATS_MARKERS - 2;
+    } else {
+        cell = 0;
+        while (height >= q.height[cell + 1]) {
+            cell++;
+        }
+    }
+
+    // Markers above the cell move up by one; desired positions advance by their fraction
+    for (uint8_t m = 0; m < BMS_STATS_MARKERS; m++) {
+        q.drift[m] += MARKER_FRACTION[m];
+        if (m > cell) {
+            q.position[m]++;
+            q.drift[m] -= ONE_Q16;
+        }
+    }
+
+    // Nudge interior markers that have drifted a whole position from where they belong
+    for (uint8_t m = 1; m < BMS_STATS_MARKERS - 1; m++) {
+        int32_t drift = q.drift[m];
+        int8_t d;
+        if (drift >= ONE_Q16 && q.position[m + 1] - q.position[m] > 1) {
+            d = 1;
+        } else if (drift <= -ONE_Q16 && q.position[m] - q.position[m - 1] > 1) {
+            d = -1;
+        } else {
+            continue;
+        }
+
+        int32_t candidate = parabolic(q, m, d);
+        if (candidate <= q.height[m - 1] || candidate >= q.height[m + 1]) {
+            // Fall back to linear interpolation towards the neighbour
+            uint8_t neighbour = d > 0 ? m + 1 : m - 1;
+            int32_t span = (int32_t)q.position[neighbour] - (int32_t)q.position[m];
+            candidate = q.height[m] + d * (q.height[neighbour] - q.height[m]) / (d * span);
+        }
+        q.height[m] = candidate;
+        q.position[m] += d;
+        q.drift[m] -= d * ONE_Q16;
+    }
+}
+
+int32_t BMSStreamStats::parabolic(const Quantiles& q, uint8_t i, int8_t d) {
+    int64_t below = (int32_t)(q.position[i] - q.position[i - 1]);
+    int64_t above = (int32_t)(q.position[i + 1] - q.position[i]);
+    int64_t rising = (below + d) * (q.height[i + 1] - q.height[i]) / above;
+    int64_t falling = (above - d) * (q.height[i] - q.height[i - 1]) / below;
+    return q.height[i] + (int32_t)(d * (rising + falling) / (below + above));
+}
+
+int32_t BMSStreamStats::quantileGet(const Quantiles& q, uint32_t count, uint8_t marker) {
+    int32_t height;
+    if (count < BMS_STATS_MARKERS) {
+        // Nearest rank over the sorted samples seen so far
+        uint32_t rank = (MARKER_FRACTION[marker] * (count - 1) + ONE_Q16 / 2) >> 16;
+        height = q.height[rank];
+    } else {
+        height = q.height[marker];
+    }
+    return (height + (height >= 0 ? 128 : -128)) / 256;
+}
+#endif
+
+uint16_t BMSStreamStats::isqrt(uint32_t value) {
+    uint32_t root = 0;
+    uint32_t bit = 1UL << 30;
+    while (bit > value) {
+        bit >>= 2;
+    }
+    while (bit != 0) {
+        if (value >= root + bit) {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root;
+}
@@ -0,0 +1,103 @@
+#ifndef BMSLIB_STATS_H
+#define BMSLIB_STATS_H
+
+#include "BMSLib.h"
+
+// Windows tracked per channel
+#ifndef BMS_STATS_MAX_WINDOWS
+#define BMS_STATS_MAX_WINDOWS   3
+#endif
+
+// P50/P95/P99 estimation (108 bytes per window; 0 compiles it out)
+#ifndef BMS_STATS_QUANTILES
+#define BMS_STATS_QUANTILES     1
+#endif
+
+#define BMS_STATS_MARKERS       9       // P² markers for three quantiles
+
+// Streaming min/max/mean/variance and quantiles of one measurement over several
+// tumbling windows at once (e.g. 1 s, 1 min, 1 h). Memory is fixed and each sample
+// costs O(1) integer work: sums are exact, quantiles use the P² algorithm with
+// fixed-point marker heights. Feed it manually with add() or attach() it to a gauge
+// so every status snapshot contributes a sample.
+class BMSStreamStats {
+public:
+    enum class Channel : uint8_t {
+        CURRENT,        // mA
+        AVERAGE_CURRENT,// mA
+        VOLTAGE,        // mV
+        TEMPERATURE     // 0.1K
+    };
+
+    struct Summary {
+        uint32_t count;
+        int32_t min;
+        int32_t max;
+        int32_t mean;           // Rounded to the channel's unit
+        uint32_t variance;      // unit²
+        uint16_t stddev;        // unit
+        int32_t p50;            // Quantiles are 0 when BMS_STATS_QUANTILES is 0
+        int32_t p95;
+        int32_t p99;
+        uint32_t start;         // millis() at the start of the window
+        uint32_t duration;      // Window length covered (ms)
+    };
+
+    explicit BMSStreamStats(Channel channel);
+    ~BMSStreamStats();
+
+    // windowMs = 0 disables the slot; defaults are 1 s, 60 s and 3600 s
+    bool setWindow(uint8_t index, uint32_t windowMs);
+
+    bool attach(BMSLib& gauge);
+    void detach();
+
+    void add(int32_t value);
+    void add(int32_t value, uint32_t now);
+    void reset();
+
+    // Last completed window; false if none has completed yet
+    bool getSummary(uint8_t index, Summary& summary) const;
+    // Window in progress
+    bool getRunning(uint8_t index, Summary& summary) const;
+
+private:
+    struct Quantiles {
+        int32_t height[BMS_STATS_MARKERS];  // Marker values, Q24.8
+        uint32_t position[BMS_STATS_MARKERS];
+        int32_t drift[BMS_STATS_MARKERS];   // Desired minus actual position, Q16
+    };
+
+    struct Window {
+        uint32_t lengthMs;
+        uint32_t start;
+        uint32_t count;
+        int32_t offset;         // First sample; sums are taken relative to it
+        int32_t min;
+        int32_t max;
+        int64_t sum;
+        uint64_t sumSquares;
+#if BMS_STATS_QUANTILES
+        Quantiles quantiles;
+#endif
+        Summary last;
+        bool completed;
+    };
+
+    Channel _channel;
+    BMSLib* _gauge;
+    Window _windows[BMS_STATS_MAX_WINDOWS];
+
+    static void onSnapshot(const BMSLib::StatusSnapshot& snapshot, void* context);
+    static void summarize(const Window& window, Summary& summary, uint32_t now);
+    static void restart(Window& window, uint32_t now);
+    static void accumulate(Window& window, int32_t value);
+#if BMS_STATS_QUANTILES
+    static void quantileAdd(Quantiles& quantiles, uint32_t count, int32_t value);
+    static int32_t quantileGet(const Quantiles& quantiles, uint32_t count, uint8_t marker);
+    static int32_t parabolic(const Quantiles& quantiles, uint8_t i, int8_t d);
+#endif
+    static uint16_t isqrt(uint32_t value);
+};
+
+#endif // BMSLIB_STATS_H
@@ -0,0 +1,300 @@
+#include "bmslib_telemetry.h"
+
+BMSTelemetry::BMSTelemetry(BMSLib& gauge, uint8_t* storage, uint16_t size) :
+    _gauge(gauge),
+    _storage(storage),
+    _size(size),
+    _intervalMs(1000) {
+    clear();
+    resetStats();
+}
+
+void BMSTelemetry::setInterval(uint16_t intervalMs) {
+    // Buffered records assume the old period, so they are discarded
+    if (intervalMs == 0 || intervalMs == _intervalMs) {
+        return;
+    }
+    _intervalMs = intervalMs;
+    clear();
+}
+
+void BMSTelemetry::clear() {
+    _head = 0;
+    _tail = 0;
+    _used = 0;
+    _count = 0;
+    _started = false;
+    memset(&_headBase, 0, sizeof(_headBase));
+    _tailBase = _headBase;
+}
+
+bool BMSTelemetry::poll() {
+    uint32_t now = millis();
+    if (!_started) {
+        _started = true;
+        _due = now;
+    }
+    if ((int32_t)(now - _due) < 0) {
+        return false;
+    }
+
+    // Timestamps follow the schedule rather than the poll, so steady sampling needs
+    // no time field. Whole periods missed by a slow loop are skipped.
+    uint32_t scheduled = _due;
+    uint32_t late = now - _due;
+    _due += _intervalMs * (late / _intervalMs + 1);
+
+    BMSLib::StatusSnapshot snapshot;
+    if (!_gauge.readStatusSnapshot(snapshot)) {
+        _stats.readFailures++;
+        return false;
+    }
+
+    Sample sample;
+    sample.time = scheduled;
+    // Raw readings: the history exists to capture the excursions the range checks zero
+    sample.voltage = snapshot.rawVoltage;
+    sample.current = snapshot.rawCurrent;
+    sample.temperature = snapshot.rawTemperature;
+    sample.flags = snapshot.flags;
+    sample.stateOfCharge = snapshot.stateOfCharge;
+    return append(sample);
+}
+
+bool BMSTelemetry::append(const Sample& sample) {
+    uint8_t record[BMS_TELEMETRY_MAX_RECORD];
+
+    uint32_t start = micros();
+    uint8_t length = encode(_headBase, sample, _intervalMs, record);
+    uint32_t elapsed = micros() - start;
+
+    if (length > _size) {
+        return false;
+    }
+    while (_size - _used < length) {
+        dropOldest();
+        _stats.dropped++;
+    }
+
+    for (uint8_t i = 0; i < length; i++) {
+        _storage[_head] = record[i];
+        if (++_head == _size) {
+            _head = 0;
+        }
+    }
+    _used += length;
+    _count++;
+    _headBase = sample;
+
+    _stats.samples++;
+    _stats.encodedBytes += length;
+    _stats.encodeMicros += elapsed;
+    if (elapsed > _stats.maxEncodeMicros) {
+        _stats.maxEncodeMicros = elapsed > 0xFFFF ? 0xFFFF : elapsed;
+    }
+    return true;
+}
+
+uint16_t BMSTelemetry::drain(Sample* out, uint16_t maxSamples) {
+    uint16_t drained = 0;
+    while (drained < maxSamples && _count > 0) {
+        dropOldest();
+        out[drained++] = _tailBase;
+    }
+    return drained;
+}
+
+uint16_t BMSTelemetry::drainEncoded(uint8_t* out, uint16_t maxBytes, Sample& base) {
+    base = _tailBase;
+
+    uint16_t written = 0;
+    uint8_t record[BMS_TELEMETRY_MAX_RECORD];
+    while (_count > 0) {
+        uint8_t length = copyRecord(_tail, record);
+        if (written + length > maxBytes) {
+            break;
+        }
+        memcpy(out + written, record, length);
+        written += length;
+        dropOldest();
+    }
+    return written;
+}
+
+uint16_t BMSTelemetry::decode(const uint8_t* data, uint16_t length, Sample& state,
+                              uint16_t intervalMs, Sample* out, uint16_t maxSamples) {
+    uint16_t position = 0;
+    uint16_t decoded = 0;
+    while (position < length && decoded < maxSamples) {
+        uint8_t used = decodeRecord(data + position, length - position, state, intervalMs);
+        if (used == 0) {
+            break;  // Truncated record
+        }
+        position += used;
+        out[decoded++] = state;
+    }
+    return decoded;
+}
+
+uint16_t BMSTelemetry::getSampleCount() const {
+    return _count;
+}
+
+uint16_t BMSTelemetry::getUsedBytes() const {
+    return _used;
+}
+
+uint16_t BMSTelemetry::getCapacity() const {
+    return _size;
+}
+
+const BMSTelemetry::Stats& BMSTelemetry::getStats() const {
+    return _stats;
+}
+
+void BMSTelemetry::resetStats() {
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+uint8_t BMSTelemetry::encode(const Sample& previous, const Sample& sample,
+                             uint16_t intervalMs, uint8_t* record) {
+    uint8_t header = 0;
+    uint8_t length = 1;
+
+    if (sample.voltage != previous.voltage) {
+        header |= FIELD_VOLTAGE;
+        length += putVarint(record + length, zigzag((int32_t)sample.voltage - previous.voltage));
+    }
+    if (sample.current != previous.current) {
+        header |= FIELD_CURRENT;
+        length += putVarint(record + length, zigzag((int32_t)sample.current - previous.current));
+    }
+    if (sample.temperature != previous.temperature) {
+        header |= FIELD_TEMPERATURE;
+        length += putVarint(record + length,
+                            zigzag((int32_t)sample.temperature - previous.temperature));
+    }
+    if (sample.stateOfCharge != previous.stateOfCharge) {
+        header |= FIELD_SOC;
+        length += putVarint(record + length,
+                            zigzag((int32_t)sample.stateOfCharge - previous.stateOfCharge));
+    }
+    if (sample.flags != previous.flags) {
+        header |= FIELD_FLAGS;
+        length += putVarint(record + length, sample.flags ^ previous.flags);
+    }
+
+    uint32_t period = sample.time - previous.time;
+    if (period != intervalMs) {
+        header |= FIELD_TIME;
+        length += putVarint(record + length, period);
+    }
+
+    record[0] = header;
+    return length;
+}
+
+uint8_t BMSTelemetry::decodeRecord(const uint8_t* record, uint16_t length,
+                                   Sample& state, uint16_t intervalMs) {
+    if (length == 0) {
+        return 0;
+    }
+
+    uint8_t header = record[0];
+    uint8_t position = 1;
+    uint32_t value;
+
+    for (uint8_t field = FIELD_VOLTAGE; field <= FIELD_TIME; field <<= 1) {
+        if ((header & field) == 0) {
+            if (field == FIELD_TIME) {
+                state.time += intervalMs;
+            }
+            continue;
+        }
+
+        uint8_t used = getVarint(record + position, length - position, value);
+        if (used == 0) {
+            return 0;
+        }
+        position += used;
+
+        switch (field) {
+            case FIELD_VOLTAGE:     state.voltage += unzigzag(value); break;
+            case FIELD_CURRENT:     state.current += unzigzag(value); break;
+            case FIELD_TEMPERATURE: state.temperature += unzigzag(value); break;
+            case FIELD_SOC:         state.stateOfCharge += unzigzag(value); break;
+            case FIELD_FLAGS:       state.flags ^= value; break;
+            case FIELD_TIME:        state.time += value; break;
+        }
+    }
+    return position;
+}
+
+uint8_t BMSTelemetry::putVarint(uint8_t* out, uint32_t value) {
+    uint8_t length = 0;
+    while (value >= 0x80) {
+        out[length++] = (value & 0x7F) | 0x80;
+        value >>= 7;
+    }
+    out[length++] = value;
+    return length;
+}
+
+uint8_t BMSTelemetry::getVarint(const uint8_t* in, uint16_t length, uint32_t& value) {
+    value = 0;
+    for (uint8_t i = 0; i < 5 && i < length; i++) {
+        value |= (uint32_t)(in[i] & 0x7F) << (7 * i);
+        if ((in[i] & 0x80) == 0) {
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+uint32_t BMSTelemetry::zigzag(int32_t value) {
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+int32_t BMSTelemetry::unzigzag(uint32_t value) {
+    return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+uint8_t BMSTelemetry::copyRecord(uint16_t position, uint8_t* record) const {
+    // Records may wrap around the end of the ring; the header says how many varints follow
+    uint8_t header = _storage[position];
+    uint8_t length = 0;
+    record[length++] = header;
+    if (++position == _size) {
+        position = 0;
+    }
+
+    for (uint8_t field = FIELD_VOLTAGE; field <= FIELD_TIME; field <<= 1) {
+        if ((header & field) == 0) {
+            continue;
+        }
+        uint8_t byte;
+        do {
+            byte = _storage[position];
+            record[length++] = byte;
+            if (++position == _size) {
+                position = 0;
+            }
+        } while ((byte & 0x80) != 0 && length < BMS_TELEMETRY_MAX_RECORD);
+    }
+    return length;
+}
+
+bool BMSTelemetry::dropOldest() {
+    if (_count == 0) {
+        return false;
+    }
+
+    uint8_t record[BMS_TELEMETRY_MAX_RECORD];
+    uint8_t length = copyRecord(_tail, record);
+    decodeRecord(record, length, _tailBase, _intervalMs);
+
+    _tail = (_tail + length) % _size;
+    _used -= length;
+    _count--;
+    return true;
+}
@@ -0,0 +1,94 @@
+#ifndef BMSLIB_TELEMETRY_H
+#define BMSLIB_TELEMETRY_H
+
+#include "BMSLib.h"
+
+// Largest encoded record: header + 3 x 3-byte varints + SoC + flags + timestamp
+#define BMS_TELEMETRY_MAX_RECORD 20
+
+// Samples a gauge at a fixed rate into a caller-supplied byte ring. Each record holds
+// only the fields that changed since the previous sample, as zigzag varint deltas,
+// so a steady pack costs 1-4 bytes per sample instead of a full status struct.
+// When the ring is full the oldest records are dropped.
+class BMSTelemetry {
+public:
+    struct Sample {
+        uint32_t time;          // millis() at the scheduled sample point
+        uint16_t voltage;       // mV
+        int16_t current;        // mA
+        uint16_t temperature;   // 0.1K
+        uint16_t flags;         // FLAGS register
+        uint8_t stateOfCharge;  // %
+    };
+
+    struct Stats {
+        uint32_t samples;       // Records appended
+        uint32_t dropped;       // Records evicted to make room
+        uint32_t readFailures;  // Scheduled samples lost to bus errors
+        uint32_t encodedBytes;  // Total record bytes written; / samples = bytes per sample
+        uint32_t encodeMicros;  // Total time spent encoding
+        uint16_t maxEncodeMicros;
+    };
+
+    BMSTelemetry(BMSLib& gauge, uint8_t* storage, uint16_t size);
+
+    void setInterval(uint16_t intervalMs);  // Sampling period, default 1000 ms; clears the ring
+    void clear();
+
+    // Take a sample if one is due; returns true when a record was appended
+    bool poll();
+    bool append(const Sample& sample);
+
+    // Decode and remove up to maxSamples of the oldest samples
+    uint16_t drain(Sample* out, uint16_t maxSamples);
+
+    // Move whole encoded records (up to maxBytes) for upload. base receives the sample
+    // the first record is relative to; decode() expands the records again.
+    uint16_t drainEncoded(uint8_t* out, uint16_t maxBytes, Sample& base);
+    static uint16_t decode(const uint8_t* data, uint16_t length, Sample& state,
+                           uint16_t intervalMs, Sample* out, uint16_t maxSamples);
+
+    uint16_t getSampleCount() const;
+    uint16_t getUsedBytes() const;
+    uint16_t getCapacity() const;
+    const Stats& getStats() const;
+    void resetStats();
+
+private:
+    enum : uint8_t {
+        FIELD_VOLTAGE     = 0x01,
+        FIELD_CURRENT     = 0x02,
+        FIELD_TEMPERATURE = 0x04,
+        FIELD_SOC         = 0x08,
+        FIELD_FLAGS       = 0x10,   // XOR with the previous flags
+        FIELD_TIME        = 0x20    // Present when the period differs from the interval
+    };
+
+    BMSLib& _gauge;
+    uint8_t* _storage;
+    uint16_t _size;
+    uint16_t _head;             // Next byte to write
+    uint16_t _tail;             // First byte of the oldest record
+    uint16_t _used;
+    uint16_t _count;
+    uint16_t _intervalMs;
+    uint32_t _due;
+    bool _started;
+    Sample _headBase;           // Last sample appended
+    Sample _tailBase;           // Sample the oldest record is relative to
+    Stats _stats;
+
+    static uint8_t encode(const Sample& previous, const Sample& sample,
+                          uint16_t intervalMs, uint8_t* record);
+    static uint8_t decodeRecord(const uint8_t* record, uint16_t length,
+                                Sample& state, uint16_t intervalMs);
+    static uint8_t putVarint(uint8_t* out, uint32_t value);
+    static uint8_t getVarint(const uint8_t* in, uint16_t length, uint32_t& value);
+    static uint32_t zigzag(int32_t value);
+    static int32_t unzigzag(uint32_t value);
+
+    uint8_t copyRecord(uint16_t position, uint8_t* record) const;
+    bool dropOldest();
+};
+
+#endif // BMSLIB_TELEMETRY_H
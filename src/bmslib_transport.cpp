@@ -0,0 +1,344 @@
+#include "BMSLib.h"
+
+// Bounded-latency transport. Every transfer is a handful of attempts, each capped by
+// the Wire timeout, separated by a doubling backoff. A hung bus (SDA held low by a
+// gauge that lost a clock mid-byte) is released with SCL pulses before the retry.
+
+#define BMS_RECOVERY_PULSES     9       // Enough to clock out any partial byte
+#define BMS_RECOVERY_HALF_US    5       // ~100 kHz
+
+void BMSLib::setTransportConfig(const TransportConfig& config) {
+    _transport = config;
+    applyWireClock();
+    applyWireTimeout();
+}
+
+const BMSLib::TransportConfig& BMSLib::getTransportConfig() const {
+    return _transport;
+}
+
+BMSLib::Status BMSLib::getLastStatus() const {
+    return _lastStatus;
+}
+
+BMSLib::Status BMSLib::readRegister(uint8_t command, uint16_t& value) {
+    if (!readWord(command, value)) {
+        return _lastStatus;
+    }
+    // A cache hit skips the bus; report it as the success it is
+    _lastStatus = Status::OK;
+    return _lastStatus;
+}
+
+BMSLib::Status BMSLib::writeRegister(uint8_t command, uint16_t value) {
+    writeWord(command, value);
+    return _lastStatus;
+}
+
+BMSLib::Status BMSLib::readRegisters(uint8_t command, uint8_t* data, uint8_t length) {
+    readBlock(command, data, length);
+    return _lastStatus;
+}
+
+BMSLib::Status BMSLib::transferRead(uint8_t command, uint8_t* data, uint8_t length) {
+    if (length == 0 || length > BMS_WIRE_BUFFER_SIZE) {
+        return finishTransfer(Status::INVALID_ARGUMENT);
+    }
+#ifdef BMS_BUS_ASYNC
+    // The bus engine still owns the bus for a split read
+    if (_splitRunning) {
+        return finishTransfer(Status::BUSY);
+    }
+#endif
+
+    Status status;
+    uint8_t attempt = 0;
+    while ((status = readOnce(command, data, length)) != Status::OK &&
+           shouldRetry(status, attempt, true)) {
+        attempt++;
+    }
+    return finishTransfer(status);
+}
+
+BMSLib::Status BMSLib::transferWrite(uint8_t command, const uint8_t* data, uint8_t length) {
+    // Command byte shares the Wire buffer with the payload
+    if (length == 0 || length >= BMS_WIRE_BUFFER_SIZE) {
+        return finishTransfer(Status::INVALID_ARGUMENT);
+    }
+#ifdef BMS_BUS_ASYNC
+    if (_splitRunning) {
+        return finishTransfer(Status::BUSY);
+    }
+#endif
+
+    // Control subcommands are not idempotent (a repeated RESET or SEALED would act
+    // twice), so they are only resent when the gauge never acknowledged its address
+    bool idempotent = command != BMS_REG_CNTL;
+
+    Status status;
+    uint8_t attempt = 0;
+    while ((status = writeOnce(command, data, length)) != Status::OK &&
+           shouldRetry(status, attempt, idempotent)) {
+        attempt++;
+    }
+    return finishTransfer(status);
+}
+
+BMSLib::Status BMSLib::readOnce(uint8_t command, uint8_t* data, uint8_t length) {
+    _wire->beginTransmission(_address);
+    _wire->write(command);
+    Status status = wireStatus(_wire->endTransmission(false));
+    if (status != Status::OK) {
+        return status;
+    }
+
+    // Gauge auto-increments the command pointer across the read
+    uint8_t received = _wire->requestFrom(_address, length);
+    if (received != length) {
+        // Discard the partial read so it cannot leak into the next transfer
+        while (_wire->available() > 0) {
+            _wire->read();
+        }
+        return wireTimedOut() ? Status::TIMEOUT : Status::SHORT_READ;
+    }
+
+    for (uint8_t i = 0; i < length; i++) {
+        data[i] = _wire->read();
+    }
+
+    _busStats.transactions++;
+    _busStats.bytes += 3 + length;  // 2x address, command, data
+    return Status::OK;
+}
+
+BMSLib::Status BMSLib::writeOnce(uint8_t command, const uint8_t* data, uint8_t length) {
+    _wire->beginTransmission(_address);
+    _wire->write(command);
+    _wire->write(data, length);
+    Status status = wireStatus(_wire->endTransmission());
+    if (status != Status::OK) {
+        return status;
+    }
+
+    _busStats.transactions++;
+    _busStats.bytes += 2 + length;  // Address, command, data
+    return Status::OK;
+}
+
+bool BMSLib::shouldRetry(Status& status, uint8_t attempt, bool idempotent) {
+    _busStats.errors++;
+
+    if (status == Status::INVALID_ARGUMENT || attempt >= _transport.retries) {
+        return false;
+    }
+    if (!idempotent && status != Status::NACK_ADDRESS) {
+        return false;
+    }
+
+    // A timeout or controller error can leave a slave driving SDA
+    if (status == Status::TIMEOUT || status == Status::BUS_ERROR ||
+        status == Status::SHORT_READ) {
+        if (_transport.sdaPin >= 0 && _transport.sclPin >= 0 && !recoverBus()) {
+            status = Status::BUS_STUCK;
+            return false;
+        }
+    }
+
+    uint32_t waitUs = static_cast<uint32_t>(_transport.backoffUs) << attempt;
+    if (waitUs >= 16000) {
+        // delayMicroseconds() is only accurate up to ~16 ms on AVR
+        delay(waitUs / 1000);
+    } else if (waitUs > 0) {
+        delayMicroseconds(waitUs);
+    }
+
+    _busStats.retries++;
+    return true;
+}
+
+BMSLib::Status BMSLib::finishTransfer(Status status) {
+    _lastStatus = status;
+    return status;
+}
+
+BMSLib::Status BMSLib::wireStatus(uint8_t code) {
+    if (code == 0) {
+        return Status::OK;
+    }
+    if (wireTimedOut()) {
+        return Status::TIMEOUT;
+    }
+
+    switch (code) {
+        case 1:  return Status::INVALID_ARGUMENT;  // Data too long for the buffer
+        case 2:  return Status::NACK_ADDRESS;
+        case 3:  return Status::NACK_DATA;
+        case 5:  return Status::TIMEOUT;
+        default: return Status::BUS_ERROR;
+    }
+}
+
+bool BMSLib::wireTimedOut() {
+#if defined(BMS_BUS_WIRE) && defined(WIRE_HAS_TIMEOUT)
+    if (_wire->getWireTimeoutFlag()) {
+        _wire->clearWireTimeoutFlag();
+        return true;
+    }
+#endif
+    return false;
+}
+
+void BMSLib::applyWireTimeout() {
+    if (_transport.timeoutUs == 0) {
+        return;
+    }
+    // Custom backends enforce their own timeout
+#if !defined(BMS_BUS_WIRE)
+#elif defined(WIRE_HAS_TIMEOUT)
+    // AVR/megaAVR cores: reset the TWI hardware instead of spinning forever
+    _wire->setWireTimeout(_transport.timeoutUs, true);
+#elif defined(ESP32)
+    _wire->setTimeOut((_transport.timeoutUs + 999) / 1000);
+#elif defined(ESP8266)
+    _wire->setClockStretchLimit(_transport.timeoutUs);
+#endif
+}
+
+void BMSLib::applyWireClock() {
+    // begin() resets the clock to the core default, so recovery calls this again
+#if defined(BMS_BUS_WIRE)
+    if (_transport.clockHz != 0) {
+        _wire->setClock(_transport.clockHz);
+    }
+#endif
+}
+
+bool BMSLib::recoverBus() {
+    if (_transport.sdaPin < 0 || _transport.sclPin < 0) {
+        return false;
+    }
+    const uint8_t sda = static_cast<uint8_t>(_transport.sdaPin);
+    const uint8_t scl = static_cast<uint8_t>(_transport.sclPin);
+
+#if defined(BMS_BUS_WIRE) && !defined(ESP8266)
+    // Hand the pins back from the TWI peripheral (the ESP8266 core bit-bangs already)
+    _wire->end();
+#endif
+
+    // Open drain by hand: drive low as OUTPUT, release high through the pull-up
+    pinMode(sda, INPUT_PULLUP);
+    pinMode(scl, INPUT_PULLUP);
+    delayMicroseconds(BMS_RECOVERY_HALF_US);
+
+    // The output latch is written low each time: on AVR INPUT_PULLUP sets it high
+    for (uint8_t i = 0; i < BMS_RECOVERY_PULSES && digitalRead(sda) == LOW; i++) {
+        digitalWrite(scl, LOW);
+        pinMode(scl, OUTPUT);
+        delayMicroseconds(BMS_RECOVERY_HALF_US);
+        pinMode(scl, INPUT_PULLUP);
+        delayMicroseconds(BMS_RECOVERY_HALF_US);
+    }
+
+    // STOP: SDA rises while SCL is high
+    digitalWrite(sda, LOW);
+    pinMode(sda, OUTPUT);
+    delayMicroseconds(BMS_RECOVERY_HALF_US);
+    pinMode(sda, INPUT_PULLUP);
+    delayMicroseconds(BMS_RECOVERY_HALF_US);
+
+    bool released = digitalRead(sda) == HIGH;
+
+#if defined(BMS_BUS_WIRE) && (defined(ESP32) || defined(ESP8266))
+    // int arguments: ESP32's begin(uint8_t, ...) overload starts a slave
+    _wire->begin(static_cast<int>(sda), static_cast<int>(scl));
+#else
+    _wire->begin();
+#endif
+    applyWireClock();
+    applyWireTimeout();
+
+    _busStats.recoveries++;
+    if (!released) {
+        _lastStatus = Status::BUS_STUCK;
+    }
+    return released;
+}
+
+// Split-phase reads. An asynchronous backend (BMS_BUS_ASYNC) provides
+//   bool startRead(uint8_t address, uint8_t command, uint8_t* data, uint8_t length);
+//   int checkRead();   // -1 while running, then an endTransmission()-style code
+// and moves the bytes itself, e.g. with the ESP-IDF i2c_master async API. Retries
+// are resubmitted at once, without the blocking backoff or bus recovery.
+
+BMSLib::Status BMSLib::startRead(uint8_t command, uint8_t* data, uint8_t length) {
+    if (_splitPending) {
+        return Status::BUSY;
+    }
+    if (length == 0 || length > BMS_WIRE_BUFFER_SIZE) {
+        return finishTransfer(Status::INVALID_ARGUMENT);
+    }
+
+#ifdef BMS_BUS_ASYNC
+    _splitCommand = command;
+    _splitLength = length;
+    _splitData = data;
+    _splitAttempt = 0;
+    _splitRunning = _wire->startRead(_address, command, data, length);
+    _splitStatus = _splitRunning ? Status::OK : Status::BUS_ERROR;
+    if (!_splitRunning) {
+        _busStats.errors++;
+    }
+#else
+    // Synchronous fallback: the transfer is over before this returns
+    _splitStatus = transferRead(command, data, length);
+    if (_splitStatus == Status::OK) {
+        cacheStoreBlock(command, data, length);
+    }
+#endif
+    _splitPending = true;
+    return Status::OK;
+}
+
+bool BMSLib::pollRead(Status& status) {
+    if (!_splitPending) {
+        return false;
+    }
+
+#ifdef BMS_BUS_ASYNC
+    while (_splitRunning) {
+        int code = _wire->checkRead();
+        if (code < 0) {
+            return false;
+        }
+
+        _splitStatus = wireStatus(static_cast<uint8_t>(code));
+        if (_splitStatus == Status::OK) {
+            _busStats.transactions++;
+            _busStats.bytes += 3 + _splitLength;  // 2x address, command, data
+            cacheStoreBlock(_splitCommand, _splitData, _splitLength);
+            _splitRunning = false;
+            break;
+        }
+
+        _busStats.errors++;
+        if (_splitAttempt >= _transport.retries || _splitStatus == Status::INVALID_ARGUMENT) {
+            _splitRunning = false;
+            break;
+        }
+        _splitAttempt++;
+        _busStats.retries++;
+        _splitRunning = _wire->startRead(_address, _splitCommand, _splitData, _splitLength);
+        if (!_splitRunning) {
+            _splitStatus = Status::BUS_ERROR;
+        }
+    }
+#endif
+
+    _splitPending = false;
+    status = finishTransfer(_splitStatus);
+    return true;
+}
+
+bool BMSLib::isReadPending() const {
+    return _splitPending;
+}
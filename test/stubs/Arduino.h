@@ -0,0 +1,70 @@
+// Minimal Arduino core for building the library on a host. Time only moves when the
+// code under test waits, so tests are deterministic.
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#ifndef ARDUINO
+#define ARDUINO 10819                  // The Makefile passes it, as the Arduino toolchain does
+#endif
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+extern uint32_t g_millis;
+extern uint32_t g_microsExtra;
+extern void (*g_isr)();
+
+inline unsigned long millis() { return g_millis; }
+inline unsigned long micros() { return g_millis * 1000UL + g_microsExtra; }
+inline void delay(unsigned long ms) { g_millis += ms; }
+inline void delayMicroseconds(unsigned int us) {
+    g_microsExtra += us;
+    g_millis += g_microsExtra / 1000;
+    g_microsExtra %= 1000;
+}
+inline void yield() { g_millis += 1; }
+
+#define HIGH                1
+#define LOW                 0
+#define INPUT               0
+#define OUTPUT              1
+#define INPUT_PULLUP        2
+#define OUTPUT_OPEN_DRAIN   3
+#define CHANGE              1
+#define FALLING             2
+#define RISING              3
+
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t, uint8_t) {}
+inline int digitalRead(uint8_t) { return HIGH; }
+inline int digitalPinToInterrupt(int pin) { return pin; }
+inline void attachInterrupt(int, void (*isr)(), int) { g_isr = isr; }
+inline void detachInterrupt(int) { g_isr = nullptr; }
+inline void noInterrupts() {}
+inline void interrupts() {}
+
+#define PROGMEM
+#define pgm_read_byte(p) (*(const uint8_t*)(p))
+#define pgm_read_word(p) (*(const uint16_t*)(p))
+
+class Stream {
+public:
+    virtual ~Stream() {}
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual size_t readBytes(uint8_t* buffer, size_t length) {
+        size_t count = 0;
+        while (count < length && available()) {
+            buffer[count++] = read();
+        }
+        return count;
+    }
+};
+
+#endif // ARDUINO_H
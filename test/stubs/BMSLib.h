@@ -0,0 +1,2 @@
+// The library header is included as BMSLib.h; map it on case-sensitive hosts
+#include "../../src/bmslib.h"
@@ -0,0 +1,146 @@
+// Host TwoWire backed by a simulated BQ34Z100: a flat register map plus data flash
+// behind the 0x3E/0x3F/0x40-0x60 block window, committed when the checksum matches.
+#ifndef WIRE_H
+#define WIRE_H
+
+#include "Arduino.h"
+
+#define BUFFER_LENGTH 32
+
+struct SimGauge {
+    uint8_t regs[256];
+    uint8_t flash[128][4][32];
+    uint8_t pointer;
+    uint8_t address;
+    uint8_t nackNext;           // NACK this many transactions
+    uint32_t transactions;
+    uint16_t transactionUs;     // Bus time each transaction takes
+    uint8_t corruptBlockData;   // Flip the low bit of this many BlockData bytes as they arrive
+    uint32_t configEnters;      // CONTROL writes of the config mode enter/exit keys
+    uint32_t configExits;
+    uint32_t commits;           // Blocks committed by a matching checksum
+    uint32_t dataWrites;        // Bytes written other than CONTROL and block selection
+
+    SimGauge() { reset(); }
+
+    void reset() {
+        memset(regs, 0, sizeof(regs));
+        memset(flash, 0, sizeof(flash));
+        pointer = 0;
+        address = 0x55;
+        nackNext = 0;
+        transactions = 0;
+        transactionUs = 0;
+        corruptBlockData = 0;
+        configEnters = 0;
+        configExits = 0;
+        commits = 0;
+        dataWrites = 0;
+    }
+
+    void setWord(uint8_t command, uint16_t value) {
+        regs[command] = value & 0xFF;
+        regs[command + 1] = value >> 8;
+    }
+
+    uint8_t blockChecksum() const {
+        uint8_t sum = 0;
+        for (int i = 0; i < 32; i++) sum += regs[0x40 + i];
+        return 255 - sum;
+    }
+
+    void loadBlock() {
+        memcpy(&regs[0x40], flash[regs[0x3E] & 0x7F][regs[0x3F] & 3], 32);
+        regs[0x60] = blockChecksum();
+    }
+
+    void writeByte(uint8_t command, uint8_t value) {
+        if (command >= 0x40 && command < 0x60 && corruptBlockData > 0) {
+            corruptBlockData--;
+            value ^= 0x01;
+        }
+        regs[command] = value;
+        if (command > 0x01 && command != 0x3E && command != 0x3F && command != 0x61) {
+            dataWrites++;
+        }
+        if (command == 0x01) {
+            uint16_t control = regs[0x00] | (regs[0x01] << 8);
+            if (control == 0x5555) configEnters++;
+            if (control == 0xAAAA) configExits++;
+        } else if (command == 0x3E || command == 0x3F) {
+            loadBlock();
+        } else if (command == 0x60 && value == blockChecksum()) {
+            memcpy(flash[regs[0x3E] & 0x7F][regs[0x3F] & 3], &regs[0x40], 32);
+            commits++;
+        }
+    }
+};
+
+extern SimGauge g_gauge;
+
+class TwoWire {
+public:
+    uint32_t muxWrites = 0;
+    uint32_t clock = 100000;
+
+    void begin() { clock = 100000; }
+    void end() {}
+    void setClock(uint32_t frequency) { clock = frequency; }
+
+    void beginTransmission(uint8_t address) { _address = address; _txLength = 0; }
+    void beginTransmission(int address) { beginTransmission(static_cast<uint8_t>(address)); }
+
+    size_t write(uint8_t value) {
+        if (_txLength >= BUFFER_LENGTH) return 0;
+        _txBuffer[_txLength++] = value;
+        return 1;
+    }
+    size_t write(const uint8_t* data, size_t length) {
+        size_t written = 0;
+        for (size_t i = 0; i < length; i++) written += write(data[i]);
+        return written;
+    }
+
+    uint8_t endTransmission(bool stop = true) {
+        (void)stop;
+        g_gauge.transactions++;
+        delayMicroseconds(g_gauge.transactionUs);
+        if ((_address & 0xF8) == 0x70) { muxWrites++; return 0; }  // TCA9548A-style mux
+        if (_address != g_gauge.address) return 2;
+        if (g_gauge.nackNext > 0) { g_gauge.nackNext--; return 2; }
+        if (_txLength == 0) return 0;
+        g_gauge.pointer = _txBuffer[0];
+        for (int i = 1; i < _txLength; i++) g_gauge.writeByte(g_gauge.pointer++, _txBuffer[i]);
+        return 0;
+    }
+
+    uint8_t requestFrom(uint8_t address, uint8_t quantity) {
+        g_gauge.transactions++;
+        delayMicroseconds(g_gauge.transactionUs);
+        if (address != g_gauge.address) return 0;
+        if (quantity > BUFFER_LENGTH) quantity = BUFFER_LENGTH;
+        for (int i = 0; i < quantity; i++) _rxBuffer[i] = g_gauge.regs[static_cast<uint8_t>(g_gauge.pointer + i)];
+        g_gauge.pointer += quantity;
+        _rxLength = quantity;
+        _rxPosition = 0;
+        return quantity;
+    }
+    uint8_t requestFrom(int address, int quantity) {
+        return requestFrom(static_cast<uint8_t>(address), static_cast<uint8_t>(quantity));
+    }
+
+    int available() { return _rxLength - _rxPosition; }
+    int read() { return _rxPosition < _rxLength ? _rxBuffer[_rxPosition++] : -1; }
+
+private:
+    uint8_t _address = 0;
+    uint8_t _txBuffer[BUFFER_LENGTH];
+    int _txLength = 0;
+    uint8_t _rxBuffer[BUFFER_LENGTH];
+    int _rxLength = 0;
+    int _rxPosition = 0;
+};
+
+extern TwoWire Wire;
+
+#endif // WIRE_H
@@ -0,0 +1,64 @@
+// Scripted asynchronous bus engine (BMS_BUS_ASYNC). A transfer moves its bytes when
+// started but reports completion only after checkRead() has said "running" polls times;
+// failCodes[] are returned, in order, for the next transfers instead of success.
+#ifndef ASYNC_BUS_H
+#define ASYNC_BUS_H
+
+#include "Wire.h"
+
+#define BMS_BUS_ASYNC
+
+class AsyncBus {
+public:
+    uint8_t polls = 3;
+    uint8_t failCodes[4] = {};
+    uint8_t failCount = 0;
+    uint32_t starts = 0;
+
+    void begin() {}
+    void beginTransmission(uint8_t address) { Wire.beginTransmission(address); }
+    size_t write(uint8_t value) { return Wire.write(value); }
+    size_t write(const uint8_t* data, size_t length) { return Wire.write(data, length); }
+    uint8_t endTransmission(bool stop = true) { return Wire.endTransmission(stop); }
+    uint8_t requestFrom(uint8_t address, uint8_t quantity) { return Wire.requestFrom(address, quantity); }
+    int available() { return Wire.available(); }
+    int read() { return Wire.read(); }
+
+    bool startRead(uint8_t address, uint8_t command, uint8_t* data, uint8_t length) {
+        if (_busy) return false;
+        _busy = true;
+        _remaining = polls;
+        starts++;
+
+        if (failCount > 0) {
+            _code = failCodes[0];
+            memmove(failCodes, failCodes + 1, sizeof(failCodes) - 1);
+            failCount--;
+            return true;
+        }
+        Wire.beginTransmission(address);
+        Wire.write(command);
+        _code = Wire.endTransmission(false);
+        if (_code == 0) {
+            if (Wire.requestFrom(address, length) != length) _code = 4;
+            for (uint8_t i = 0; i < length; i++) data[i] = Wire.read();
+        }
+        return true;
+    }
+
+    int checkRead() {
+        if (!_busy) return 4;
+        if (_remaining > 0) { _remaining--; return -1; }
+        _busy = false;
+        return _code;
+    }
+
+private:
+    bool _busy = false;
+    uint8_t _remaining = 0;
+    uint8_t _code = 0;
+};
+
+extern AsyncBus g_asyncBus;
+
+#endif // ASYNC_BUS_H
@@ -0,0 +1,8 @@
+#include "Wire.h"
+
+uint32_t g_millis = 0;
+uint32_t g_microsExtra = 0;
+void (*g_isr)() = nullptr;
+
+SimGauge g_gauge;
+TwoWire Wire;
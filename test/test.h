@@ -0,0 +1,18 @@
+// Shared helpers for the host tests: a failed CHECK prints and fails the run
+#ifndef BMSLIB_TEST_H
+#define BMSLIB_TEST_H
+
+#include <stdio.h>
+
+static int g_failures = 0;
+
+#define CHECK(condition) do { \
+    if (!(condition)) { \
+        printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+        g_failures++; \
+    } \
+} while (0)
+
+#define TEST_RESULT() (printf("%s\n", g_failures == 0 ? "PASS" : "FAIL"), g_failures == 0 ? 0 : 1)
+
+#endif // BMSLIB_TEST_H
@@ -0,0 +1,51 @@
+// Alarms must trip on the readings the snapshot range checks reject
+#include "bmslib_alarm.h"
+#include "test.h"
+
+static void setReadings(uint16_t millivolts, int16_t milliamps, uint16_t decikelvin) {
+    g_gauge.setWord(BMS_REG_VOLT, millivolts);
+    g_gauge.setWord(BMS_REG_CURRENT, static_cast<uint16_t>(milliamps));
+    g_gauge.setWord(BMS_REG_TEMP, decikelvin);
+    g_gauge.regs[BMS_REG_SOC] = 50;
+}
+
+static void configure(BMSAlarmEngine& alarms) {
+    alarms.setThreshold(BMSAlarmEngine::OVER_VOLTAGE, 4250, 4200);
+    alarms.setThreshold(BMSAlarmEngine::OVER_CURRENT, 5000, 4500);
+    alarms.setThreshold(BMSAlarmEngine::OVER_TEMPERATURE, 3331, 3281);     // 60C / 55C
+}
+
+static void checkRaised(const BMSAlarmEngine& alarms) {
+    CHECK(alarms.isActive(BMSAlarmEngine::OVER_VOLTAGE));
+    CHECK(alarms.isActive(BMSAlarmEngine::OVER_CURRENT));
+    CHECK(alarms.isActive(BMSAlarmEngine::OVER_TEMPERATURE));
+}
+
+int main() {
+    BMSLib gauge;
+
+    // 4.6 V, 6 A discharge, 75 C
+    setReadings(4600, -6000, 3481);
+    {
+        BMSAlarmEngine alarms(gauge);
+        configure(alarms);
+        CHECK(alarms.tick());
+        checkRaised(alarms);
+    }
+    {
+        BMSAlarmEngine alarms(gauge);
+        configure(alarms);
+        BMSLib::StatusSnapshot snapshot;
+        CHECK(gauge.readStatusSnapshot(snapshot));
+        alarms.evaluate(snapshot);
+        checkRaised(alarms);
+
+        // Back in range: every alarm clears
+        setReadings(4000, 1000, 2981);
+        CHECK(gauge.readStatusSnapshot(snapshot));
+        alarms.evaluate(snapshot);
+        CHECK(alarms.getActiveMask() == 0);
+    }
+
+    return TEST_RESULT();
+}
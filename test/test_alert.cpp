@@ -0,0 +1,28 @@
+// A pin alert whose snapshot read fails stays pending until a retry succeeds
+#include "bmslib_alert.h"
+#include "test.h"
+
+int main() {
+    BMSLib gauge;
+    BMSAlertMonitor monitor(gauge);
+    CHECK(monitor.begin(2));
+    CHECK(g_isr != nullptr);
+
+    g_isr();
+    g_gauge.nackNext = 100;
+    CHECK(!monitor.poll());
+    CHECK(monitor.isAlertPending());
+    CHECK(monitor.getStats().failures == 1);
+
+    // Retries wait for the retry interval, then succeed once the bus is back
+    g_gauge.nackNext = 0;
+    CHECK(!monitor.poll());
+    CHECK(monitor.getIdleTimeMs() > 0 && monitor.getIdleTimeMs() <= BMS_ALERT_RETRY_INTERVAL);
+    delay(BMS_ALERT_RETRY_INTERVAL);
+    CHECK(monitor.poll());
+    CHECK(!monitor.isAlertPending());
+    CHECK(monitor.getStats().alertReads == 1);
+    CHECK(monitor.getStats().alerts == 1);
+
+    return TEST_RESULT();
+}
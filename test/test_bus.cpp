@@ -0,0 +1,28 @@
+// Bus manager topology checks and deadline scheduling across mux channels
+#include "bmslib_bus.h"
+#include "test.h"
+
+int main() {
+    BMSLib a;
+    BMSLib b;
+    BMSLib c;
+    BMSBusManager bus;
+    int8_t mux = bus.addMux(Wire);
+    CHECK(mux == 0);
+
+    CHECK(bus.addGauge(a, -2, 0) < 0);
+    CHECK(bus.addGauge(a, 1, 0) < 0);
+    CHECK(bus.addGauge(a, mux, 8) < 0);
+
+    CHECK(bus.addGauge(a, mux, 0, 100) == 0);
+    CHECK(bus.addGauge(b, mux, 1, 100) == 1);
+    CHECK(bus.addGauge(c, mux, 0, 100) == 2);
+    bus.setSchedule(BMSBusManager::Schedule::DEADLINE);
+
+    // After a on channel 0, c is reachable without a switch and goes before b
+    CHECK(bus.poll(3) == 3);
+    CHECK(bus.getStats().muxSwitches == 2);
+    CHECK(bus.getSnapshotAge(2) <= bus.getSnapshotAge(1));
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,60 @@
+// The read cache must not serve BlockData window registers across block selections
+#include "BMSLib.h"
+#include "test.h"
+
+#include <new>
+
+// A gauge object built over dirty memory must start with an empty cache
+static void checkFreshCache(uint8_t fill) {
+    alignas(BMSLib) static unsigned char storage[sizeof(BMSLib)];
+    memset(storage, fill, sizeof(storage));
+    BMSLib* gauge = new (storage) BMSLib();
+    gauge->enableCache();
+
+    uint16_t value = 0;
+    for (int i = 0; i < 6; i++) {
+        CHECK(gauge->readRegister(BMS_REG_DCAP, value) == BMSLib::Status::OK);
+        CHECK(gauge->readRegister(fill, value) == BMSLib::Status::OK);
+    }
+    CHECK(gauge->getCacheStats().hits == 5);
+    CHECK(gauge->getCacheStats().misses == 1);
+    gauge->~BMSLib();
+}
+
+int main() {
+    checkFreshCache(0xFF);
+    checkFreshCache(0x05);
+
+    BMSLib gauge;
+    gauge.enableCache();
+
+    // Identity registers are cached until written
+    g_gauge.setWord(BMS_REG_DCAP, 2000);
+    CHECK(gauge.readDesignCapacity() == 2000);
+    g_gauge.setWord(BMS_REG_DCAP, 2500);
+    CHECK(gauge.readDesignCapacity() == 2000);
+
+    // The window follows the selected block; a second read must see the new block
+    uint16_t value = 0;
+    g_gauge.flash[48][0][0] = 0x11;
+    g_gauge.flash[49][0][0] = 0x22;
+    g_gauge.writeByte(BMS_REG_DFCLS, 48);
+    CHECK(gauge.readRegister(BMS_REG_CHEM, value) == BMSLib::Status::OK);
+    CHECK((value & 0xFF) == 0x11);
+    g_gauge.writeByte(BMS_REG_DFCLS, 49);
+    CHECK(gauge.readRegister(BMS_REG_CHEM, value) == BMSLib::Status::OK);
+    CHECK((value & 0xFF) == 0x22);
+
+    // Even when pinned, a block selection through the library drops the cached value
+    g_gauge.flash[48][0][1] = 0x33;
+    g_gauge.flash[49][0][1] = 0x44;
+    g_gauge.writeByte(BMS_REG_DFCLS, 49);
+    CHECK(gauge.setCacheTtl(BMS_REG_SELF_DISCH, BMS_CACHE_TTL_STATIC));
+    CHECK(gauge.readRegister(BMS_REG_SELF_DISCH, value) == BMSLib::Status::OK);
+    CHECK((value & 0xFF) == 0x44);
+    CHECK(gauge.writeRegister(BMS_REG_DFCLS, 48) == BMSLib::Status::OK);
+    CHECK(gauge.readRegister(BMS_REG_SELF_DISCH, value) == BMSLib::Status::OK);
+    CHECK((value & 0xFF) == 0x33);
+
+    return TEST_RESULT();
+}
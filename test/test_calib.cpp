@@ -0,0 +1,95 @@
+// Calibration sampler: the confidence half-width stays exact for the widest 16-bit
+// readings at the sample limit, where the scaled spread nears 2^64, and the multi-point
+// fit recovers a known gain and offset
+#include "bmslib_calib.h"
+#include "test.h"
+
+// Run on a steady reading so the mean is exactly that reading
+static void measure(BMSCalibrationSampler& sampler, BMSCalibrationSampler::Quantity quantity,
+                    uint8_t reg, uint16_t reading) {
+    g_gauge.setWord(reg, reading);
+    CHECK(sampler.start(quantity, 0));
+    while (sampler.poll()) {
+    }
+}
+
+static void checkFit() {
+    BMSLib gauge;
+    BMSCalibrationSampler sampler(gauge);
+    sampler.setSampleInterval(0);
+    sampler.setSampleLimits(2, 2);
+    BMSCalibrationSampler::Fit fit;
+
+    // No run yet, and no points
+    CHECK(!sampler.addPoint(350000));
+    CHECK(!sampler.getFit(fit));
+
+    // Reference meter reads 1.02 x the gauge plus 1 mV; values in hundredths
+    const uint16_t readings[] = { 3000, 3500, 4000 };
+    for (uint8_t i = 0; i < 3; i++) {
+        measure(sampler, BMSCalibrationSampler::VOLTAGE, BMS_REG_VOLT, readings[i]);
+        CHECK(sampler.addPoint(static_cast<int32_t>(readings[i]) * 102 + 100));
+    }
+    CHECK(sampler.getPointCount() == 3);
+    CHECK(sampler.getFit(fit));
+    CHECK(fit.points == 3);
+    CHECK(fit.gain == 1020);
+    CHECK(fit.offset == 100);
+    CHECK(fit.measured == 350000);
+    CHECK(fit.actual == 350000 * 102 / 100 + 100);
+
+    // Points must all be of one quantity, and not taken mid-run
+    measure(sampler, BMSCalibrationSampler::TEMPERATURE, BMS_REG_TEMP, 2981);
+    CHECK(!sampler.addPoint(298100));
+    CHECK(sampler.start(BMSCalibrationSampler::VOLTAGE, 0));
+    CHECK(!sampler.addPoint(350000));
+    sampler.stop();
+
+    // One point: gain only
+    sampler.clearPoints();
+    measure(sampler, BMSCalibrationSampler::TEMPERATURE, BMS_REG_TEMP, 2981);
+    CHECK(sampler.addPoint(301100));
+    CHECK(sampler.getFit(fit));
+    CHECK(fit.gain == 301100LL * 1000 / 298100);
+    CHECK(fit.offset == 0);
+
+    // Every point at the same reading: no slope
+    CHECK(sampler.addPoint(302100));
+    CHECK(!sampler.getFit(fit));
+
+    // The table holds BMS_CAL_MAX_POINTS
+    while (sampler.getPointCount() < BMS_CAL_MAX_POINTS) {
+        CHECK(sampler.addPoint(301100));
+    }
+    CHECK(!sampler.addPoint(301100));
+}
+
+int main() {
+    checkFit();
+
+    BMSLib gauge;
+    BMSCalibrationSampler sampler(gauge);
+    sampler.setSampleInterval(0);
+    sampler.setSampleLimits(2, 1024);
+
+    // Alternate between the ends of the register range; the bound is never met
+    const uint16_t low = 0;
+    const uint16_t high = 65534;
+    CHECK(sampler.start(BMSCalibrationSampler::VOLTAGE, 0));
+    for (uint16_t i = 0; sampler.isRunning(); i++) {
+        g_gauge.setWord(BMS_REG_VOLT, i % 2 == 0 ? low : high);
+        sampler.poll();
+    }
+
+    const BMSCalibrationSampler::Estimate& estimate = sampler.getEstimate(BMSCalibrationSampler::VOLTAGE);
+    CHECK(estimate.count == 1024);
+    CHECK(!estimate.converged);
+    CHECK(estimate.mean == (low + high) / 2 * 100);
+
+    // Sample standard deviation (high - low) / 2 * sqrt(n / (n - 1)); t(95%, >30 dof) = 2.04
+    const double standardError = (high - low) / 2.0 * sqrt(1024.0 / 1023.0) / sqrt(1024.0) * 100;
+    const double expected = standardError * 2.04;
+    CHECK(fabs(estimate.halfWidth - expected) < expected * 0.001);
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,76 @@
+// Config sessions: nested scopes enter and leave config mode once, and a write that fails
+// inside a rollback session restores every register the session had changed
+#include "BMSLib.h"
+#include "test.h"
+
+static void checkNesting() {
+    BMSLib gauge;
+    g_gauge.configEnters = 0;
+    g_gauge.configExits = 0;
+
+    // performFullCalibration() wraps three calibrate calls that each begin and end config
+    BMSLib::VoltageCalibration vcal = { 3700, 3690 };
+    BMSLib::CurrentCalibration ccal = { 1000, 990, 5000 };
+    BMSLib::TempCalibration tcal = { 2981, 2975 };
+    CHECK(gauge.performFullCalibration(vcal, ccal, tcal));
+    CHECK(g_gauge.configEnters == 1);
+    CHECK(g_gauge.configExits == 1);
+
+    // A session nested in another joins it; only the outer commit leaves config mode
+    {
+        BMSLib::ConfigSession outer(gauge);
+        CHECK(outer.active());
+        {
+            BMSLib::ConfigSession inner(gauge);
+            CHECK(gauge.setDesignCapacity(4000));
+            CHECK(inner.commit());
+        }
+        CHECK(g_gauge.configExits == 1);
+        CHECK(gauge.setFullChargeCapacity(3900));
+        CHECK(outer.commit());
+    }
+    CHECK(g_gauge.configEnters == 2);
+    CHECK(g_gauge.configExits == 2);
+}
+
+static void checkRollback() {
+    BMSLib gauge;
+    g_gauge.setWord(BMS_REG_DCAP, 3000);
+    g_gauge.setWord(BMS_REG_FCC, 2900);
+    g_gauge.configExits = 0;
+
+    {
+        BMSLib::ConfigSession session(gauge, true);
+        CHECK(gauge.setDesignCapacity(5000));
+        CHECK(gauge.setFullChargeCapacity(4800));
+        CHECK(session.ok());
+
+        // Every attempt of the next write is NACKed; DCAP is journaled already
+        g_gauge.nackNext = 1 + BMS_TRANSPORT_RETRIES;
+        CHECK(!gauge.setDesignCapacity(6000));
+        CHECK(g_gauge.nackNext == 0);
+        CHECK(!session.ok());
+        CHECK(!session.commit());
+    }
+
+    CHECK((g_gauge.regs[BMS_REG_DCAP] | (g_gauge.regs[BMS_REG_DCAP + 1] << 8)) == 3000);
+    CHECK((g_gauge.regs[BMS_REG_FCC] | (g_gauge.regs[BMS_REG_FCC + 1] << 8)) == 2900);
+    CHECK(g_gauge.configExits == 1);
+
+    // Without rollback the successful writes stay
+    {
+        BMSLib::ConfigSession session(gauge);
+        CHECK(gauge.setDesignCapacity(5000));
+        g_gauge.nackNext = 1 + BMS_TRANSPORT_RETRIES;
+        CHECK(!gauge.setFullChargeCapacity(4800));
+        CHECK(!session.commit());
+    }
+    CHECK((g_gauge.regs[BMS_REG_DCAP] | (g_gauge.regs[BMS_REG_DCAP + 1] << 8)) == 5000);
+    CHECK((g_gauge.regs[BMS_REG_FCC] | (g_gauge.regs[BMS_REG_FCC + 1] << 8)) == 2900);
+}
+
+int main() {
+    checkNesting();
+    checkRollback();
+    return TEST_RESULT();
+}
@@ -0,0 +1,42 @@
+// Block-mode data flash writes: a block that arrives intact is committed and verified, and
+// one corrupted in transit fails the checksum, is not committed, and fails the write
+#include "BMSLib.h"
+#include "test.h"
+
+int main() {
+    BMSLib gauge;
+    CHECK(gauge.enterConfigMode());
+
+    uint8_t block[BMS_DATAFLASH_BLOCK_SIZE];
+    for (uint8_t i = 0; i < sizeof(block); i++) {
+        block[i] = i * 7;
+    }
+    CHECK(gauge.writeDataFlashBlock(48, 0, block));
+    CHECK(memcmp(g_gauge.flash[48][0], block, sizeof(block)) == 0);
+
+    uint8_t readBack[BMS_DATAFLASH_BLOCK_SIZE];
+    CHECK(gauge.readDataFlashBlock(48, 0, readBack));
+    CHECK(memcmp(readBack, block, sizeof(block)) == 0);
+
+    // One flipped bit: the gauge's checksum no longer matches the one the library sends
+    uint8_t changed[BMS_DATAFLASH_BLOCK_SIZE];
+    memcpy(changed, block, sizeof(changed));
+    changed[5] = 0x55;
+    g_gauge.corruptBlockData = 1;
+    CHECK(!gauge.writeDataFlashBlock(48, 0, changed));
+    CHECK(memcmp(g_gauge.flash[48][0], block, sizeof(block)) == 0);
+
+    // The same through a shadow flush, which commits only the changed byte range
+    CHECK(gauge.writeShadow(48, 5, &changed[5], 1));
+    g_gauge.corruptBlockData = 1;
+    CHECK(!gauge.flushShadow());
+    CHECK(g_gauge.flash[48][0][5] == block[5]);
+
+    // Intact again
+    CHECK(gauge.writeShadow(48, 5, &changed[5], 1));
+    CHECK(gauge.flushShadow());
+    CHECK(g_gauge.flash[48][0][5] == 0x55);
+
+    CHECK(gauge.exitConfigMode());
+    return TEST_RESULT();
+}
@@ -0,0 +1,86 @@
+// Binary frames: CRC check value, a snapshot round trip that keeps out-of-range readings,
+// sparse presence bitmaps, and decoder resynchronisation
+#include "bmslib_frame.h"
+#include "test.h"
+
+#include <string.h>
+
+int main() {
+    // CRC-16/CCITT-FALSE check value
+    CHECK(BMSFrame::crc16(reinterpret_cast<const uint8_t*>("123456789"), 9) == 0x29B1);
+
+    BMSLib gauge;
+    g_gauge.setWord(BMS_REG_VOLT, 4600);
+    g_gauge.setWord(BMS_REG_CURRENT, static_cast<uint16_t>(-6000));
+    g_gauge.setWord(BMS_REG_TEMP, 2981);
+    g_gauge.regs[BMS_REG_SOC] = 87;
+    g_gauge.setWord(BMS_REG_FLAGS, 0x0201);
+
+    BMSLib::StatusSnapshot snapshot;
+    CHECK(gauge.readStatusSnapshot(snapshot));
+
+    BMSFrame::Record record = {};
+    record.timestamp = 123456789UL;
+    record.present = BMSFrame::mask(BMSFrame::TIMESTAMP);
+    BMSFrame::fromSnapshot(snapshot, record);
+
+    uint8_t frame[BMS_FRAME_MAX_SIZE];
+    size_t length = BMSFrame::encode(record, 42, frame, sizeof(frame));
+    CHECK(length == BMSFrame::encodedSize(record.present));
+    CHECK(frame[0] == BMS_FRAME_SYNC);
+    CHECK(BMSFrame::encode(record, 42, frame, length - 1) == 0);
+
+    BMSFrame::Record decoded;
+    uint8_t sequence = 0;
+    size_t consumed = 0;
+    CHECK(BMSFrame::decode(frame, length, decoded, sequence, consumed) ==
+          BMSFrame::DecodeResult::OK);
+    CHECK(consumed == length);
+    CHECK(sequence == 42);
+    CHECK(decoded.present == record.present);
+    CHECK(decoded.timestamp == 123456789UL);
+    CHECK(decoded.voltage == 4600);
+    CHECK(decoded.current == -6000);
+    CHECK(decoded.temperature == 2981);
+    CHECK(decoded.stateOfCharge == 87);
+    CHECK(decoded.flags == 0x0201);
+
+    // Sparse bitmap: only the set fields are carried, the rest decode as 0
+    BMSFrame::Record sparse = {};
+    sparse.present = BMSFrame::mask(BMSFrame::STATE_OF_HEALTH) |
+                     BMSFrame::mask(BMSFrame::PACK_VOLTAGE_RANGE);
+    sparse.stateOfHealth = 96;
+    sparse.maxPackVoltage = 4210;
+    sparse.minPackVoltage = 3020;
+    sparse.voltage = 3700;
+    length = BMSFrame::encode(sparse, 7, frame, sizeof(frame));
+    CHECK(length == BMS_FRAME_HEADER_SIZE + 1 + 4 + BMS_FRAME_CRC_SIZE);
+    CHECK(BMSFrame::decode(frame, length, decoded, sequence, consumed) ==
+          BMSFrame::DecodeResult::OK);
+    CHECK(decoded.present == sparse.present);
+    CHECK(decoded.stateOfHealth == 96);
+    CHECK(decoded.maxPackVoltage == 4210 && decoded.minPackVoltage == 3020);
+    CHECK(decoded.voltage == 0);
+
+    // An empty bitmap is a header and CRC only
+    BMSFrame::Record empty = {};
+    CHECK(BMSFrame::encode(empty, 0, frame, sizeof(frame)) ==
+          BMS_FRAME_HEADER_SIZE + BMS_FRAME_CRC_SIZE);
+
+    // Garbage before a frame, a truncated frame and a corrupted frame
+    uint8_t stream[4 + BMS_FRAME_MAX_SIZE];
+    memset(stream, 0x11, 4);
+    length = BMSFrame::encode(sparse, 8, stream + 4, sizeof(stream) - 4);
+    CHECK(BMSFrame::decode(stream, 4 + length, decoded, sequence, consumed) ==
+          BMSFrame::DecodeResult::BAD_SYNC);
+    CHECK(consumed == 4);
+    CHECK(BMSFrame::decode(stream + 4, length - 1, decoded, sequence, consumed) ==
+          BMSFrame::DecodeResult::INCOMPLETE);
+    CHECK(consumed == 0);
+    stream[4 + BMS_FRAME_HEADER_SIZE] ^= 0x01;
+    CHECK(BMSFrame::decode(stream + 4, length, decoded, sequence, consumed) ==
+          BMSFrame::DecodeResult::BAD_CRC);
+    CHECK(consumed == 1);
+
+    return TEST_RESULT();
+}
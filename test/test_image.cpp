@@ -0,0 +1,94 @@
+// Golden image: an image the unit already matches writes nothing, and one changed byte
+// commits its block with only that byte and the checksum. begin(image) checks the
+// fingerprint with reads only and names the records that differ
+#include "BMSLib.h"
+#include "test.h"
+
+static const uint8_t IMAGE[] = {
+    BMS_IMAGE_DF(48, 4, 3), 0x11, 0x22, 0x33,
+    BMS_IMAGE_DF(48, 30, 4), 0x44, 0x55, 0x66, 0x77,   // Spans blocks 0 and 1
+    BMS_IMAGE_DF(82, 0, 2), 0x10, 0x0E,
+    BMS_IMAGE_REG(BMS_REG_DCAP, 3000)
+};
+
+static void provision() {
+    const uint8_t block48[] = { 0x11, 0x22, 0x33 };
+    memcpy(&g_gauge.flash[48][0][4], block48, sizeof(block48));
+    g_gauge.flash[48][0][30] = 0x44;
+    g_gauge.flash[48][0][31] = 0x55;
+    g_gauge.flash[48][1][0] = 0x66;
+    g_gauge.flash[48][1][1] = 0x77;
+    g_gauge.flash[82][0][0] = 0x10;
+    g_gauge.flash[82][0][1] = 0x0E;
+    g_gauge.setWord(BMS_REG_DCAP, 3000);
+}
+
+int main() {
+    BMSLib gauge;
+    BMSLib::ImageResult result;
+
+    // Already matching: every block is read, nothing is written
+    provision();
+    g_gauge.commits = 0;
+    g_gauge.dataWrites = 0;
+    CHECK(gauge.compareImage(IMAGE, sizeof(IMAGE), result));
+    CHECK(gauge.applyImage(IMAGE, sizeof(IMAGE), result));
+    CHECK(result.blocksChecked == 3);
+    CHECK(result.blocksChanged == 0);
+    CHECK(result.registersChanged == 0);
+    CHECK(result.bytesWritten == 0);
+    CHECK(g_gauge.commits == 0);
+    CHECK(g_gauge.dataWrites == 0);
+
+    // One byte off in the second block of subclass 48
+    g_gauge.flash[48][1][1] = 0x78;
+    uint8_t before[2][BMS_DATAFLASH_BLOCK_SIZE];
+    memcpy(before, g_gauge.flash[48], sizeof(before));
+    CHECK(!gauge.compareImage(IMAGE, sizeof(IMAGE), result));
+    CHECK(result.blocksChanged == 1);
+    CHECK(g_gauge.commits == 0);
+
+    CHECK(gauge.applyImage(IMAGE, sizeof(IMAGE), result));
+    CHECK(result.blocksChanged == 1);
+    CHECK(result.registersChanged == 0);
+    CHECK(result.bytesWritten == 1);
+    CHECK(g_gauge.commits == 1);
+    CHECK(g_gauge.dataWrites == 2);     // The byte and the checksum
+    CHECK(g_gauge.flash[48][1][1] == 0x77);
+    before[1][1] = 0x77;
+    CHECK(memcmp(before, g_gauge.flash[48], sizeof(before)) == 0);
+
+    // A register that differs is written on its own
+    g_gauge.setWord(BMS_REG_DCAP, 2000);
+    g_gauge.commits = 0;
+    g_gauge.dataWrites = 0;
+    CHECK(gauge.applyImage(IMAGE, sizeof(IMAGE), result));
+    CHECK(result.blocksChanged == 0);
+    CHECK(result.registersChanged == 1);
+    CHECK(g_gauge.commits == 0);
+    CHECK(g_gauge.dataWrites == 2);
+    CHECK((g_gauge.regs[BMS_REG_DCAP] | (g_gauge.regs[BMS_REG_DCAP + 1] << 8)) == 3000);
+
+    // Warm boot on a provisioned unit: reads only
+    uint32_t differing = 0xFFFFFFFFUL;
+    g_gauge.commits = 0;
+    g_gauge.dataWrites = 0;
+    CHECK(gauge.begin(IMAGE, sizeof(IMAGE), &differing));
+    CHECK(differing == 0);
+    CHECK(g_gauge.commits == 0);
+    CHECK(g_gauge.dataWrites == 0);
+
+    // The third record (subclass 82) differs: only its bit is set, and one block is fixed
+    g_gauge.flash[82][0][1] = 0x0F;
+    CHECK(gauge.begin(IMAGE, sizeof(IMAGE), &differing));
+    CHECK(differing == (1UL << 2));
+    CHECK(g_gauge.commits == 1);
+    CHECK(g_gauge.dataWrites == 2);
+    CHECK(g_gauge.flash[82][0][1] == 0x0E);
+
+    CHECK(gauge.begin(IMAGE, sizeof(IMAGE), &differing));
+    CHECK(differing == 0);
+    CHECK(g_gauge.commits == 1);
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,87 @@
+// Batch provisioner: while one unit settles after a mode switch the next one is driven,
+// so units move through each stage in turn and the batch takes about as long as one unit
+#include "bmslib_provision.h"
+#include "test.h"
+
+#define UNITS   3
+
+typedef BMSProvisioner::Stage Stage;
+
+struct Event {
+    uint8_t unit;
+    Stage stage;
+};
+
+static uint32_t runBatch(BMSLib* gauges, uint8_t count, const BMSProvisioner::Plan& plan,
+                         Event* events, uint8_t& eventCount) {
+    BMSProvisioner provisioner;
+    for (uint8_t i = 0; i < count; i++) {
+        CHECK(provisioner.addUnit(gauges[i], plan) == i);
+    }
+
+    Stage last[UNITS];
+    for (uint8_t i = 0; i < count; i++) {
+        last[i] = Stage::QUEUED;
+    }
+    eventCount = 0;
+
+    CHECK(provisioner.start());
+    bool running = true;
+    while (running) {
+        running = provisioner.poll();
+        for (uint8_t i = 0; i < count; i++) {
+            Stage stage = provisioner.getResult(i).stage;
+            if (stage != last[i] && eventCount < 64) {
+                events[eventCount].unit = i;
+                events[eventCount].stage = stage;
+                eventCount++;
+                last[i] = stage;
+            }
+        }
+        yield();
+    }
+    CHECK(provisioner.getFailedCount() == 0);
+    for (uint8_t i = 0; i < count; i++) {
+        CHECK(provisioner.getResult(i).failedStage == Stage::DONE);
+    }
+    return provisioner.getElapsedMs();
+}
+
+int main() {
+    BMSLib::CapacityConfig capacity = { 3000, 11100, 300, 95, 5 };
+    BMSProvisioner::Plan plan = {};
+    plan.factoryReset = true;
+    plan.setChemistry = true;
+    plan.chemistry = BMSLib::BatteryChemistry::LIFEPO4;
+    plan.capacity = &capacity;
+
+    BMSLib gauges[UNITS];
+    Event events[64];
+    uint8_t eventCount = 0;
+
+    uint32_t single = runBatch(gauges, 1, plan, events, eventCount);
+    uint32_t batch = runBatch(gauges, UNITS, plan, events, eventCount);
+
+    // Each unit settles while the others are driven: far from UNITS x the single chain
+    CHECK(batch < single + single / 2);
+
+    // Every unit starts its reset before any unit moves on, and every later switch is
+    // taken unit by unit in the same order
+    for (uint8_t i = 0; i < UNITS; i++) {
+        CHECK(events[i].unit == i && events[i].stage == Stage::FACTORY_RESET);
+    }
+    const Stage switches[] = { Stage::ENTER_CONFIG, Stage::CHEMISTRY, Stage::EXIT_CONFIG, Stage::DONE };
+    uint8_t position = UNITS;
+    for (Stage stage : switches) {
+        uint8_t next = 0;
+        for (uint8_t e = position; e < eventCount; e++) {
+            if (events[e].stage == stage) {
+                CHECK(events[e].unit == next);
+                next++;
+            }
+        }
+        CHECK(next == UNITS);
+    }
+
+    return TEST_RESULT();
+}
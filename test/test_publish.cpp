@@ -0,0 +1,110 @@
+// Seqlock publisher under real concurrency: one owner thread publishes snapshots whose
+// words and timestamp all carry the same counter, reader threads check they never see a mix.
+// poll() keeps to its interval from the first attempt, even while reads fail
+#include "bmslib_publish.h"
+#include "test.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#define PUBLICATIONS    60000   // Counter stays within 16 bits
+#define READERS         4
+
+static void setCounter(uint16_t counter) {
+    const uint8_t words[] = {
+        BMS_REG_RM, BMS_REG_FCC, BMS_REG_VOLT, BMS_REG_AI, BMS_REG_TEMP, BMS_REG_FLAGS, BMS_REG_CURRENT
+    };
+    for (uint8_t command : words) {
+        g_gauge.setWord(command, counter);
+    }
+}
+
+static bool consistent(const BMSLib::StatusSnapshot& s) {
+    const uint16_t counter = s.remainingCapacity;
+    return s.fullCapacity == counter && s.rawVoltage == counter &&
+           static_cast<uint16_t>(s.averageCurrent) == counter && s.rawTemperature == counter &&
+           s.flags == counter && static_cast<uint16_t>(s.rawCurrent) == counter;
+}
+
+static void checkPollInterval() {
+    BMSLib gauge;
+    BMSSnapshotPublisher publisher(gauge);
+    publisher.setInterval(100);
+    g_millis = 5000;
+
+    // A dead gauge is tried once per interval, not on every call
+    g_gauge.nackNext = 255;
+    CHECK(!publisher.poll());
+    uint32_t transactions = g_gauge.transactions;
+    g_millis += 50;
+    CHECK(!publisher.poll());
+    CHECK(g_gauge.transactions == transactions);
+
+    g_gauge.nackNext = 0;
+    g_millis += 50;
+    CHECK(publisher.poll());
+    CHECK(publisher.getPublishCount() == 1);
+    g_millis += 99;
+    CHECK(!publisher.poll());
+    CHECK(publisher.getPublishCount() == 1);
+}
+
+int main() {
+    checkPollInterval();
+
+    BMSLib gauge;
+    BMSSnapshotPublisher publisher(gauge);
+    CHECK(publisher.begin());
+
+    std::atomic<bool> done(false);
+    std::atomic<uint32_t> torn(0);
+    std::atomic<uint32_t> backwards(0);
+    std::atomic<uint32_t> reads(0);
+
+    std::vector<std::thread> readers;
+    for (int i = 0; i < READERS; i++) {
+        readers.emplace_back([&]() {
+            uint16_t last = 0;
+            uint32_t count = 0;
+            while (!done.load(std::memory_order_relaxed)) {
+                BMSLib::StatusSnapshot snapshot;
+                uint32_t timestamp = 0;
+                if (!publisher.read(snapshot, &timestamp)) {
+                    continue;
+                }
+                count++;
+                if (!consistent(snapshot) || timestamp != snapshot.remainingCapacity) {
+                    torn++;
+                } else if (snapshot.remainingCapacity < last) {
+                    backwards++;
+                } else {
+                    last = snapshot.remainingCapacity;
+                }
+            }
+            reads += count;
+        });
+    }
+
+    // Owner thread: the only one that touches the gauge and the bus
+    for (uint32_t i = 1; i <= PUBLICATIONS; i++) {
+        setCounter(static_cast<uint16_t>(i));
+        g_millis = i;
+        CHECK(publisher.sample());
+    }
+    done = true;
+    for (std::thread& reader : readers) {
+        reader.join();
+    }
+
+    CHECK(reads > 0);
+    CHECK(publisher.getPublishCount() == PUBLICATIONS);
+    CHECK(torn == 0);
+    CHECK(backwards == 0);
+
+    BMSLib::StatusSnapshot last;
+    CHECK(publisher.read(last));
+    CHECK(last.remainingCapacity == PUBLICATIONS);
+
+    return TEST_RESULT();
+}
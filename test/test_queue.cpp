@@ -0,0 +1,111 @@
+// Transfer queue on an asynchronous engine with an 8-byte Wire buffer: snapshots move in
+// word-aligned chunks, callbacks see their results, the next read starts in the poll that
+// completes the last one, a full queue rejects, and a callback can submit a follow-up
+#include "bmslib_queue.h"
+#include "test.h"
+
+AsyncBus g_asyncBus;
+
+static BMSTransferQueue* g_queue;
+static uint8_t g_readData[2];
+static uint8_t g_reads = 0;
+static uint8_t g_resubmits = 0;
+static BMSLib::Status g_fieldStatus[2];
+static uint16_t g_fieldValue[2];
+static uint8_t g_fields = 0;
+static uint8_t g_snapshots = 0;
+static uint8_t g_listened = 0;
+
+static void onRead(BMSLib::Status status, const uint8_t* data, uint8_t length, void* context) {
+    CHECK(status == BMSLib::Status::OK);
+    CHECK(length == 2 && (data[0] | (data[1] << 8)) == 3650);
+    g_reads++;
+
+    // Follow-up from inside the callback, while the queue is full
+    uint8_t* remaining = static_cast<uint8_t*>(context);
+    if (*remaining > 0) {
+        (*remaining)--;
+        CHECK(g_queue->submitRead(BMS_REG_DCAP, g_readData, sizeof(g_readData), onRead, context));
+        g_resubmits++;
+    }
+}
+
+static void onField(BMSLib::Field, BMSLib::Status status, uint16_t value, void*) {
+    g_fieldStatus[g_fields] = status;
+    g_fieldValue[g_fields] = value;
+    g_fields++;
+}
+
+static void onSnapshot(BMSLib::Status status, const BMSLib::StatusSnapshot& snapshot, void*) {
+    CHECK(status == BMSLib::Status::OK);
+    CHECK(snapshot.voltage == 3812);
+    CHECK(snapshot.current == -1200);
+    CHECK(snapshot.temperature == 2981);
+    CHECK(snapshot.stateOfCharge == 64);
+    CHECK(snapshot.flags == 0x0201);
+    CHECK(snapshot.transactions == 3);
+    g_snapshots++;
+}
+
+static void onListen(const BMSLib::StatusSnapshot&, void*) {
+    g_listened++;
+}
+
+int main() {
+    BMSLib gauge(g_asyncBus);
+    BMSTransferQueue queue(gauge);
+    g_queue = &queue;
+    gauge.addSnapshotListener(onListen);
+
+    g_gauge.setWord(BMS_REG_VOLT, 3812);
+    g_gauge.setWord(BMS_REG_CURRENT, static_cast<uint16_t>(-1200));
+    g_gauge.setWord(BMS_REG_TEMP, 2981);
+    g_gauge.regs[BMS_REG_SOC] = 64;
+    g_gauge.setWord(BMS_REG_FLAGS, 0x0201);
+    g_gauge.setWord(BMS_REG_DCAP, 3650);
+
+    // A 20-byte snapshot through an 8-byte buffer: chunks of 8, 8 and 4
+    BMSLib::StatusSnapshot snapshot;
+    CHECK(queue.submitSnapshot(snapshot, onSnapshot));
+    queue.flush();
+    CHECK(g_snapshots == 1);
+    CHECK(g_listened == 1);
+    CHECK(g_asyncBus.starts == 3);
+    CHECK(queue.getStats().completed == 1);
+
+    // Fill the queue; the fifth submission is rejected
+    uint8_t remaining = 2;
+    CHECK(queue.submitRead(BMS_REG_DCAP, g_readData, sizeof(g_readData), onRead, &remaining));
+    CHECK(queue.submitField(BMSLib::Field::VOLTAGE, onField));
+    g_gauge.setWord(BMS_REG_TEMP, 9000);    // Out of range by the time it is read
+    CHECK(queue.submitField(BMSLib::Field::TEMPERATURE, onField));
+    CHECK(queue.submitSnapshot(snapshot, nullptr));
+    CHECK(!queue.submitField(BMSLib::Field::CURRENT, onField));
+    CHECK(queue.getStats().rejected == 1);
+    CHECK(queue.getStats().maxDepth == 4);
+
+    // Back-to-back: the poll that delivers a callback has already started the next read
+    uint32_t starts = g_asyncBus.starts;
+    uint8_t polls = 0;
+    while (queue.poll() == 0 && polls < 20) {
+        polls++;
+    }
+    CHECK(g_reads == 1);
+    CHECK(g_asyncBus.starts == starts + 1 + 1);
+    CHECK(gauge.isReadPending());
+    CHECK(queue.getPending() == 4);     // The callback's follow-up took the freed slot
+
+    queue.flush();
+    CHECK(g_reads == 3);
+    CHECK(g_resubmits == 2);
+    CHECK(g_fields == 2);
+    CHECK(g_fieldStatus[0] == BMSLib::Status::OK && g_fieldValue[0] == 3812);
+    CHECK(g_fieldStatus[1] == BMSLib::Status::OUT_OF_RANGE);
+    CHECK(g_listened == 2);
+    CHECK(queue.isIdle());
+    CHECK(!gauge.isReadPending());
+    CHECK(queue.getStats().completed == 1 + 5);
+    CHECK(queue.getStats().failed == 1);
+
+    return TEST_RESULT();
+}
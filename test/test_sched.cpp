@@ -0,0 +1,73 @@
+// Bus scheduler: bulk data-flash steps never stretch the gap between safety reads past
+// its limit, and a failed safety read holds bulk work back until one succeeds
+#include "bmslib_sched.h"
+#include "test.h"
+
+static uint32_t g_lastSafety = 0;
+static uint32_t g_maxGap = 0;
+static uint32_t g_safetyCount = 0;
+static int16_t g_lastCurrent = 0;
+static int g_jobsDone = 0;
+
+static void onSafety(uint16_t, int16_t current, void*) {
+    uint32_t now = micros();
+    if (g_safetyCount > 0 && now - g_lastSafety > g_maxGap) {
+        g_maxGap = now - g_lastSafety;
+    }
+    g_lastSafety = now;
+    g_safetyCount++;
+    g_lastCurrent = current;
+}
+
+static void onJob(bool success, uint8_t, uint8_t, void*) {
+    CHECK(success);
+    g_jobsDone++;
+}
+
+int main() {
+    BMSLib gauge;
+    BMSBusScheduler scheduler(gauge);
+    CHECK(scheduler.setSafetyInterval(20, 40));
+    scheduler.setTelemetryInterval(0);
+    scheduler.setSafetyCallback(onSafety);
+
+    // Each transaction takes 2 ms, so one block step (~8 transactions) is a large
+    // part of the 40 ms gap
+    g_gauge.transactionUs = 2000;
+    g_gauge.setWord(BMS_REG_CURRENT, static_cast<uint16_t>(-7000));
+
+    uint8_t blocks[4][32];
+    for (uint8_t i = 0; i < 4; i++) {
+        CHECK(scheduler.readBlock(48 + i, 0, blocks[i], onJob));
+    }
+    CHECK(!scheduler.readBlock(60, 0, blocks[0]));
+
+    for (int i = 0; i < 2000 && (g_jobsDone < 4 || scheduler.getPendingJobs() > 0); i++) {
+        scheduler.poll();
+        delay(1);
+    }
+    CHECK(g_jobsDone == 4);
+    CHECK(scheduler.getStats().bulkSteps == 4);
+    CHECK(scheduler.getStats().maxSafetyGapUs <= 40000);
+    // Callback timestamps trail the poll start by the safety read itself (2 transactions)
+    CHECK(g_maxGap <= 40000 + 2 * 2000);
+    CHECK(g_lastCurrent == -7000);
+
+    // With the gauge gone, safety reads fail and no bulk step may run in between
+    uint8_t extra[32];
+    CHECK(scheduler.readBlock(48, 0, extra));
+    g_gauge.nackNext = 255;
+    delay(20);
+    BMSBusScheduler::Stats before = scheduler.getStats();
+    scheduler.poll();
+    CHECK(scheduler.getStats().failures == before.failures + 1);
+    for (int i = 0; i < 30; i++) {
+        scheduler.poll();
+        delay(5);
+    }
+    CHECK(scheduler.getStats().bulkSteps == before.bulkSteps);
+    CHECK(scheduler.getStats().safetyReads == before.safetyReads);
+    CHECK(scheduler.getStats().failures > before.failures);
+
+    return TEST_RESULT();
+}
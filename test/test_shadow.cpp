@@ -0,0 +1,31 @@
+// Data flash shadow: gauge-updated subclasses stay fresh, failed flushes do not linger
+#include "BMSLib.h"
+#include "test.h"
+
+int main() {
+    BMSLib gauge;
+
+    // Lifetime Data changes under the library's feet; every read must see it
+    BMSLib::LifetimeStats stats;
+    g_gauge.flash[59][0][0] = 0x10;
+    CHECK(gauge.getLifetimeStats(stats));
+    CHECK(stats.maxTemp == 0x10);
+    g_gauge.flash[59][0][0] = 0x20;
+    CHECK(gauge.getLifetimeStats(stats));
+    CHECK(stats.maxTemp == 0x20);
+
+    // A flush the gauge rejects drops the block instead of leaving it dirty
+    uint8_t value = 0xA5;
+    uint8_t readBack = 0;
+    CHECK(gauge.readShadow(48, 13, &readBack, 1));
+    CHECK(gauge.writeShadow(48, 13, &value, 1));
+    CHECK(gauge.isShadowDirty());
+    g_gauge.nackNext = 100;
+    CHECK(!gauge.flushShadow());
+    g_gauge.nackNext = 0;
+    CHECK(!gauge.isShadowDirty());
+    CHECK(gauge.readShadow(48, 13, &readBack, 1));
+    CHECK(readBack == g_gauge.flash[48][0][13]);
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,43 @@
+// Snapshot reads: listeners fire once per completed read, and a Wire buffer smaller
+// than the snapshot window falls back to chunked reads (built with BMS_WIRE_BUFFER_SIZE 8)
+#include "BMSLib.h"
+#include "test.h"
+
+static int g_notified = 0;
+
+static void onSnapshot(const BMSLib::StatusSnapshot&, void*) {
+    g_notified++;
+}
+
+int main() {
+    BMSLib gauge;
+    CHECK(gauge.addSnapshotListener(onSnapshot));
+
+    g_gauge.regs[BMS_REG_SOC] = 42;
+    g_gauge.setWord(BMS_REG_VOLT, 3700);
+    g_gauge.setWord(BMS_REG_TEMP, 2981);
+    g_gauge.setWord(BMS_REG_CURRENT, static_cast<uint16_t>(-1500));
+    g_gauge.setWord(BMS_REG_FLAGSB, 0x1234);
+
+    BMSLib::StatusSnapshot snapshot;
+    CHECK(gauge.readStatusSnapshot(snapshot));
+    CHECK(snapshot.stateOfCharge == 42);
+    CHECK(snapshot.voltage == 3700);
+    CHECK(snapshot.temperature == 2981);
+    CHECK(snapshot.current == -1500);
+    CHECK(snapshot.flagsB == 0x1234);
+    CHECK(snapshot.transactions == (BMS_SNAPSHOT_LENGTH + 7) / 8);
+    CHECK(g_notified == 1);
+
+    // Decoding alone is not a new reading
+    uint8_t buffer[BMS_SNAPSHOT_LENGTH] = {};
+    gauge.decodeStatusSnapshot(buffer, snapshot);
+    CHECK(g_notified == 1);
+
+    BMSLib::DetailedStatus status;
+    CHECK(gauge.getDetailedStatus(status));
+    CHECK(status.stateOfCharge == 42);
+    CHECK(g_notified == 2);
+
+    return TEST_RESULT();
+}
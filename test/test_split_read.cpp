@@ -0,0 +1,45 @@
+// Split-phase reads on an asynchronous engine: blocking calls back off while the engine
+// owns the bus, and a NACK mid-sequence is resubmitted by pollRead()
+#include "BMSLib.h"
+#include "test.h"
+
+AsyncBus g_asyncBus;
+
+int main() {
+    BMSLib gauge(g_asyncBus);
+    g_gauge.setWord(BMS_REG_VOLT, 3812);
+
+    g_asyncBus.failCodes[0] = 2;    // First attempt: address NACK
+    g_asyncBus.failCount = 1;
+
+    uint8_t data[2] = {};
+    BMSLib::Status status = BMSLib::Status::OK;
+    CHECK(gauge.startRead(BMS_REG_VOLT, data, sizeof(data)) == BMSLib::Status::OK);
+    CHECK(gauge.startRead(BMS_REG_VOLT, data, sizeof(data)) == BMSLib::Status::BUSY);
+
+    // Engine busy: the blocking path must not touch the bus
+    uint32_t before = g_gauge.transactions;
+    uint16_t value = 0;
+    CHECK(gauge.readRegister(BMS_REG_VOLT, value) == BMSLib::Status::BUSY);
+    CHECK(gauge.writeRegister(BMS_REG_CNTL, 0) == BMSLib::Status::BUSY);
+    CHECK(g_gauge.transactions == before);
+
+    // Three "running" polls; the fourth sees the NACK and resubmits within the same call,
+    // which uses one of the retry's three; two more, then the data
+    int polls = 0;
+    while (!gauge.pollRead(status) && polls < 20) {
+        polls++;
+    }
+    CHECK(polls == 6);
+    CHECK(status == BMSLib::Status::OK);
+    CHECK(g_asyncBus.starts == 2);
+    CHECK((data[0] | (data[1] << 8)) == 3812);
+    CHECK(gauge.getBusStats().retries == 1);
+    CHECK(!gauge.isReadPending());
+
+    // Engine idle again: blocking reads go through
+    CHECK(gauge.readRegister(BMS_REG_VOLT, value) == BMSLib::Status::OK);
+    CHECK(value == 3812);
+
+    return TEST_RESULT();
+}
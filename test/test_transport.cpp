@@ -0,0 +1,21 @@
+// Bus recovery restarts Wire; the configured clock must survive it
+#include "BMSLib.h"
+#include "test.h"
+
+int main() {
+    BMSLib gauge;
+    BMSLib::TransportConfig config = gauge.getTransportConfig();
+    CHECK(config.clockHz == 0);
+
+    config.sdaPin = 4;
+    config.sclPin = 5;
+    config.clockHz = 400000;
+    gauge.setTransportConfig(config);
+    CHECK(Wire.clock == 400000);
+
+    CHECK(gauge.recoverBus());
+    CHECK(Wire.clock == 400000);
+    CHECK(gauge.getBusStats().recoveries == 1);
+
+    return TEST_RESULT();
+}